@@ -0,0 +1,220 @@
+/// @file asio_sink.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <functional>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/execution/executor.hpp>
+#include <boost/asio/execution/outstanding_work.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/system/error_code.hpp>
+
+#if defined( BOOST_ASIO_HAS_CO_AWAIT )
+#    include <boost/asio/awaitable.hpp>
+#    include <boost/asio/use_awaitable.hpp>
+#endif
+
+#include <logger/logger.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+namespace impl {
+
+
+/// Учет работы исполнителя (как boost::asio::executor_work_guard) для исполнителей
+/// обоих видов: стандартных (any_io_executor, strand) и устаревших (io_context::strand)
+template< typename Executor >
+auto trackWork( const Executor& executor, std::enable_if_t< boost::asio::execution::is_executor< Executor >::value >* = nullptr )
+{
+     return boost::asio::prefer( executor, boost::asio::execution::outstanding_work.tracked );
+}
+
+template< typename Executor >
+auto trackWork( const Executor& executor, std::enable_if_t< !boost::asio::execution::is_executor< Executor >::value >* = nullptr )
+{
+     return boost::asio::make_work_guard( executor );
+}
+
+template< typename Executor >
+const Executor& executorOf( const Executor& executor ) { return executor; }
+
+template< typename Executor >
+Executor executorOf( const boost::asio::executor_work_guard< Executor >& work ) { return work.get_executor(); }
+
+
+} // namespace impl
+
+
+/// Асинхронный приемник записей для приложений на основе boost::asio.
+///
+/// Записи только копируются в очередь в памяти (без ввода-вывода), а вывод в дескриптор
+/// выполняется асинхронно на strand указанного исполнителя, поэтому логгирование
+/// не останавливает цикл событий приложения.
+///
+/// @note Запись в обычный файл через epoll не бывает асинхронной: она выполняется
+/// целиком в обработчике на исполнителе приемника. Для файлов передавайте исполнитель
+/// выделенного контекста (например, boost::asio::thread_pool{ 1 }), чтобы медленный диск
+/// не останавливал основной цикл событий.
+///
+class AsioSink : public boost::enable_shared_from_this< AsioSink > {
+public:
+     using Executor = boost::asio::any_io_executor;
+
+     static constexpr auto defaultMaxQueued = 16u * 1024u * 1024u;
+
+     /// Создает приемник, пишущий в дескриптор @a fd (pipe, tty, сокет или файл).
+     /// Приемник становится владельцем дескриптора.
+     static boost::shared_ptr< AsioSink > create(
+          const Executor& executor
+          , int fd
+          , std::size_t maxQueued = AsioSink::defaultMaxQueued
+          );
+
+     /// Ставит данные в очередь на вывод и никогда не блокируется на вводе-выводе.
+     /// Если в очереди уже больше @a maxQueued байт, данные отбрасываются
+     /// (и учитываются в @a dropped()).
+     void enqueue( const char* s, std::size_t n );
+
+     /// Асинхронно ожидает вывода всех данных, поставленных в очередь до вызова.
+     /// Сигнатура обработчика: void( boost::system::error_code ).
+     template< typename CompletionToken >
+     auto asyncFlush( CompletionToken&& token )
+     {
+          return boost::asio::async_initiate< CompletionToken, void( boost::system::error_code ) >(
+               [ self = shared_from_this() ]( auto handler )
+               {
+                    /// Пока вывод не завершен, исполнитель обработчика должен считать,
+                    /// что у него есть работа: иначе его цикл событий (например, io_context::run()
+                    /// в другом контексте, чем приемник) завершится, не дождавшись вызова обработчика
+                    auto work = impl::trackWork( boost::asio::get_associated_executor( handler, self->strand_ ) );
+                    using Handler = decltype( handler );
+                    using Work = decltype( work );
+                    struct Operation {
+                         Handler handler;
+                         Work work;
+                    };
+                    auto op = std::make_shared< Operation >( Operation{ std::move( handler ), std::move( work ) } );
+                    self->addFlushWaiter(
+                         [ op ]( const boost::system::error_code& ec )
+                         {
+                              boost::asio::post( impl::executorOf( op->work ), [ op, ec ]{ op->handler( ec ); } );
+                         });
+               }
+               , token
+               );
+     }
+
+     std::size_t maxQueued() const noexcept { return maxQueued_; }
+
+     /// Возвращает кол-во байт, отброшенных из-за переполнения очереди
+     std::size_t dropped() const noexcept;
+
+private:
+     using FlushWaiter = std::function< void( const boost::system::error_code& ) >;
+
+     AsioSink( const Executor& executor, int fd, std::size_t maxQueued );
+
+     void addFlushWaiter( FlushWaiter&& waiter );
+     void startWrite();
+     void onWritten( const boost::system::error_code& ec, std::size_t n );
+
+     boost::asio::strand< Executor > strand_;
+     boost::asio::posix::stream_descriptor descriptor_;
+     const std::size_t maxQueued_;
+
+     /// Защищает только очередь и счетчики, ввод-вывод под ним не выполняется
+     mutable boost::mutex mutex_;
+     std::string pending_;
+     std::string inflight_;
+     bool writing_ = false;
+     boost::system::error_code error_;
+     std::size_t enqueued_ = 0u;
+     std::size_t written_ = 0u;
+     std::size_t dropped_ = 0u;
+     std::list< std::pair< std::size_t, FlushWaiter > > waiters_;
+};
+
+
+using AsioSinkPtr = boost::shared_ptr< AsioSink >;
+
+
+/// Устройство Boost.Iostreams для записи в @a AsioSink.
+///
+/// Как и @a ShmRingSink, копит данные до сброса потока, который @a Logger выполняет
+/// после каждой записи, и ставит в очередь всю запись одним вызовом @a AsioSink::enqueue().
+/// Поэтому при переполнении очереди запись отбрасывается целиком, а не с середины.
+///
+class AsioSinkDevice {
+public:
+     using char_type = char;
+     struct category : boost::iostreams::sink_tag, boost::iostreams::flushable_tag {};
+
+     explicit AsioSinkDevice( AsioSinkPtr sink ) : sink_{ sink } {}
+
+     std::streamsize write( const char_type* s, std::streamsize n )
+     {
+          pending_.append( s, static_cast< std::size_t >( n ) );
+          /// Такая запись не поместится в очередь в любом случае
+          if( pending_.size() > sink_->maxQueued() )
+          {
+               flush();
+          }
+          return n;
+     }
+
+     bool flush()
+     {
+          if( !pending_.empty() )
+          {
+               sink_->enqueue( pending_.data(), pending_.size() );
+               pending_.clear();
+          }
+          return true;
+     }
+
+private:
+     AsioSinkPtr sink_;
+     std::string pending_;
+};
+
+
+/// Создает выходной поток, пишущий в @a sink, для использования в качестве приемника @a Logger
+OstreamPtr makeAsioOstream( AsioSinkPtr sink );
+
+
+#if defined( BOOST_ASIO_HAS_CO_AWAIT )
+/// Ожидание вывода всех данных @a sink для сопрограмм C++20.
+/// При ошибке вывода бросает boost::system::system_error.
+///
+/// @note Свободная функция, а не метод @a AsioSink: иначе определение класса
+/// зависело бы от стандарта, с которым собрана единица трансляции.
+///
+inline boost::asio::awaitable< void > awaitFlush( AsioSinkPtr sink )
+{
+     co_await sink->asyncFlush( boost::asio::use_awaitable );
+}
+#endif
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -0,0 +1,26 @@
+/// @file level.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Не используем enum class чтобы меньше было писать:
+/// вместо Level::Info - просто Info.
+///
+/// @note Не переопределяйте индексы значений,
+/// они используются в качестве индексов массива!
+enum Level {
+     Debug,
+     Info,
+     Warn,
+     Error
+};
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -7,6 +7,7 @@
 #include <iosfwd>
 #include <iostream>
 
+#include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/core/addressof.hpp>
 #include <boost/core/null_deleter.hpp>
@@ -17,26 +18,15 @@
 #include <boost/thread/lock_guard.hpp>
 #include <boost/atomic.hpp>
 
+#include <logger/level.h>
 #include <logger/rotator.h>
+#include <logger/overload.h>
 
 
 namespace alexen {
 namespace tiny_logger {
 
 
-/// Не используем enum class чтобы меньше было писать:
-/// вместо Level::Info - просто Info.
-///
-/// @note Не переопределяйте индексы значений,
-/// они используются в качестве индексов массива!
-enum Level {
-     Debug,
-     Info,
-     Warn,
-     Error
-};
-
-
 /// Единичная запись в лог.
 ///
 /// @note Пишет сразу в целевой поток без лишнего копирования
@@ -44,20 +34,26 @@ enum Level {
 ///
 class LoggerRecord {
 public:
-     LoggerRecord( boost::unique_lock< boost::mutex >&& lock, std::ostream& os, const Level level );
+     LoggerRecord( boost::unique_lock< boost::timed_mutex >&& lock, std::ostream& os, const Level level );
      ~LoggerRecord();
 
+     /// Создает отброшенную запись, которая ничего никуда не пишет
+     LoggerRecord() noexcept = default;
+
      /// Используем шаблон чтобы по полной использовать
      /// все перегрузки потокового оператора вывода
      template< typename T >
      LoggerRecord& operator<<( const T& value )
      {
-          os_ << value;
+          if( os_ )
+          {
+               *os_ << value;
+          }
           return *this;
      }
 private:
-     boost::unique_lock< boost::mutex > lock_;
-     std::ostream& os_;
+     boost::unique_lock< boost::timed_mutex > lock_;
+     std::ostream* os_ = nullptr;
 };
 
 
@@ -102,8 +98,26 @@ public:
           const std::string& appName
           , const boost::filesystem::path& logDir
           , OstreamPtr console = makeOstreamPtr( std::cerr )
+          , std::size_t maxLogSize = Rotator::defaultMaxLogSize
+          , unsigned maxLogFiles = Rotator::defaultMaxLogFiles
+          , boost::optional< OverloadController::Settings > overload = OverloadController::Settings{}
      );
 
+     /// Логгирование во внешний приемник @a sink без обращений к файловой системе.
+     /// Ротацией логов в этом случае занимается сторона, читающая из приемника
+     /// (например, @a ShmRing и утилита tiny_logger_writer).
+     ///
+     /// @note В отличие от логгирования в файл, дублирование на консоль по умолчанию выключено:
+     /// синхронный вывод в std::cerr под мьютексом свел бы на нет смысл внешнего приемника.
+     explicit Logger(
+          OstreamPtr sink
+          , OstreamPtr console = nullptr
+          , boost::optional< OverloadController::Settings > overload = OverloadController::Settings{}
+          );
+
+     /// Выводит в лог кол-во записей, отброшенных при перегрузке и еще не попавших в сводку
+     ~Logger();
+
      /// Основной метод вывода в лог с указанием уровня логгирования
      LoggerRecord operator()( const Level );
 
@@ -119,12 +133,18 @@ public:
      std::size_t totalRecords() const noexcept { return totalRecords_.value(); }
      std::size_t totalChars() const noexcept { return totalChars_.value(); }
 
+     /// Контроллер перегрузки (nullptr, если отбрасывание записей при перегрузке отключено)
+     const OverloadController* overload() const noexcept { return overload_.get_ptr(); }
+
 private:
      void prepareLogDirectory();
+     bool waitForLock( boost::unique_lock< boost::timed_mutex >& lock, Level level );
+     void reportOverload( const boost::unique_lock< boost::timed_mutex >& );
      void setFilteringStreams();
-     void startLoggingInto( const boost::unique_lock< boost::mutex >&, const boost::filesystem::path& path );
+     void startLoggingInto( const boost::unique_lock< boost::timed_mutex >&, const boost::filesystem::path& path );
 
-     Rotator rotator_;
+     /// Отсутствует при логгировании во внешний приемник
+     boost::optional< Rotator > rotator_;
 
      boost::atomic< std::size_t > totalRecords_ = { 0 };
      boost::atomic< std::size_t > totalChars_ = { 0 };
@@ -132,11 +152,17 @@ private:
      /// Опциональный указатель на дополнительный (дублирующий) выходной поток.
      /// Предполагается, что это будет std::cerr, но использовать можно любой std::ostream.
      OstreamPtr console_;
+     OstreamPtr sink_;
      boost::filesystem::ofstream ofile_;
      Counter counter_;
      boost::iostreams::filtering_ostream olog_;
 
-     boost::mutex mutex_;
+     /// Отсутствует, если отбрасывание записей при перегрузке отключено
+     boost::optional< OverloadController > overload_;
+     /// Минимальный уровень, о котором уже сообщено в лог (защищен мьютексом)
+     Level reportedLevel_ = Debug;
+
+     boost::timed_mutex mutex_;
 };
 
 
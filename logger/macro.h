@@ -5,10 +5,11 @@
 #pragma once
 
 #include <string_view>
-#include <c++/11/filesystem>
 #include <boost/filesystem/path.hpp>
+#include <boost/preprocessor/cat.hpp>
 
 #include <logger/logger.h>
+#include <logger/timing.h>
 
 
 namespace alexen {
@@ -39,3 +40,25 @@ constexpr std::string_view filename( std::string_view path )
 #define LOG_INFO( logger )    LOG_PRIVATE( logger.info )
 #define LOG_WARN( logger )    LOG_PRIVATE( logger.warn )
 #define LOG_ERROR( logger )   LOG_PRIVATE( logger.error )
+
+
+/// Замер времени выполнения блока кода до конца текущей области видимости.
+/// Время выводится в лог, только если оно не меньше порога (по умолчанию @a ScopeTimer::defaultThreshold).
+#define LOG_SCOPE_TIME_OVER( logger, name, threshold ) \
+     const alexen::tiny_logger::ScopeTimer BOOST_PP_CAT( tinyLoggerScopeTimer, __LINE__ ){ \
+          logger, alexen::tiny_logger::inner::filename( __FILE__ ), __LINE__, name, threshold }
+
+#define LOG_SCOPE_TIME( logger, name ) \
+     LOG_SCOPE_TIME_OVER( logger, name, alexen::tiny_logger::ScopeTimer::defaultThreshold )
+
+
+/// Накопление статистики времени выполнения блока кода в точке вызова
+/// с выводом сводки в лог раз в период (по умолчанию @a TimingStat::defaultReportPeriod).
+#define LOG_SCOPE_STAT_PERIOD( logger, name, period ) \
+     static alexen::tiny_logger::TimingStat BOOST_PP_CAT( tinyLoggerTimingStat, __LINE__ ){ \
+          alexen::tiny_logger::inner::filename( __FILE__ ), __LINE__, name, period }; \
+     const alexen::tiny_logger::ScopeStatTimer BOOST_PP_CAT( tinyLoggerScopeStatTimer, __LINE__ ){ \
+          BOOST_PP_CAT( tinyLoggerTimingStat, __LINE__ ), logger }
+
+#define LOG_SCOPE_STAT( logger, name ) \
+     LOG_SCOPE_STAT_PERIOD( logger, name, alexen::tiny_logger::TimingStat::defaultReportPeriod )
@@ -0,0 +1,111 @@
+/// @file overload.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include <boost/atomic.hpp>
+
+#include <logger/level.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Настройки контроллера перегрузки @a OverloadController
+struct OverloadSettings {
+     using Clock = std::chrono::steady_clock;
+
+     /// Время без прогресса, после которого вывод считается зависшим
+     Clock::duration maxLockWait = std::chrono::milliseconds{ 10 };
+     /// Минимальное время между шагами восстановления уровней
+     Clock::duration restoreDelay = std::chrono::seconds{ 5 };
+     /// Минимальное время между поднятиями уровня
+     Clock::duration raiseDelay = std::chrono::seconds{ 1 };
+};
+
+
+/// Контроллер перегрузки логгера.
+///
+/// При зависании выходного потока (медленный диск, зависший stderr) пошагово поднимает
+/// минимальный уровень записей: сначала отбрасываются @a Debug, затем @a Info. Записи
+/// уровня @a Warn и выше не отбрасываются никогда. Уровень поднимается не чаще раза
+/// в @a raiseDelay, чтобы одно зависание не подняло его сразу до @a Warn. Когда давление
+/// спадает, уровни так же пошагово восстанавливаются (не чаще раза в @a restoreDelay).
+///
+/// Зависанием считается только отсутствие прогресса: ни одна запись не получила мьютекс
+/// логгера за @a maxLockWait (см. @a Logger). Обычная конкуренция потоков за мьютекс,
+/// при которой записи продолжают выводиться, зависанием не считается.
+///
+/// @note Проверка @a shed() не захватывает никаких блокировок, поэтому
+/// отбрасываемые записи не ждут мьютекс логгера.
+///
+class OverloadController {
+public:
+     using Clock = std::chrono::steady_clock;
+
+     using Settings = OverloadSettings;
+
+     /// Кол-во отброшенных записей по уровням
+     using ShedStat = std::array< std::size_t, Error + 1 >;
+
+     explicit OverloadController( const Settings& settings = Settings{} );
+
+     Clock::duration maxLockWait() const noexcept { return settings_.maxLockWait; }
+
+     /// Текущий минимальный уровень записей, попадающих в лог
+     Level minLevel() const noexcept { return minLevel_.load( boost::memory_order_relaxed ); }
+
+     /// Признак того, что часть записей сейчас отбрасывается
+     bool degraded() const noexcept { return minLevel() > Debug; }
+
+     /// Возвращает true, если запись уровня @a level нужно отбросить
+     /// (такая запись учитывается в статистике отброшенных записей)
+     bool shed( const Level level ) noexcept
+     {
+          return level < minLevel() && shedSlow( level );
+     }
+
+     /// Учитывает запись уровня @a level, отброшенную из-за зависания вывода,
+     /// и поднимает минимальный уровень, если с прошлого поднятия прошло @a raiseDelay.
+     /// Возвращает true, если уровень был поднят.
+     bool onStall( Level level ) noexcept;
+
+     /// Понижает минимальный уровень на один шаг, если за время @a restoreDelay
+     /// зависаний не было. В этом случае возвращает true, а в @a stat - кол-во записей,
+     /// отброшенных с момента предыдущего восстановления.
+     ///
+     /// @note Вызывается под мьютексом логгера.
+     ///
+     bool tryRestore( ShedStat& stat ) noexcept;
+
+     /// Возвращает в @a stat кол-во записей, отброшенных с момента предыдущего
+     /// восстановления (или предыдущего вызова), и обнуляет счетчики.
+     /// Возвращает false, если отброшенных записей не было.
+     bool takeShedStat( ShedStat& stat ) noexcept;
+
+     /// Общее кол-во записей, отброшенных за время жизни контроллера
+     std::size_t totalShed() const noexcept { return totalShed_.load( boost::memory_order_relaxed ); }
+
+private:
+     bool shedSlow( Level level ) noexcept;
+     bool pressureSubsided( Clock::time_point now ) const noexcept;
+
+     const Settings settings_;
+
+     boost::atomic< Level > minLevel_ = { Debug };
+     /// Время последнего зависания (или последнего шага восстановления)
+     boost::atomic< Clock::rep > lastPressure_ = { 0 };
+     /// Время последнего поднятия уровня
+     boost::atomic< Clock::rep > lastRaise_;
+     std::array< boost::atomic< std::size_t >, Error + 1 > shed_ = {};
+     boost::atomic< std::size_t > totalShed_ = { 0 };
+};
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -0,0 +1,74 @@
+/// @file ring_writer.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <logger/rotator.h>
+#include <logger/shm_ring.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Вывод одного кольцевого буфера (@a ShmRing) в отдельную серию лог-файлов с ротацией.
+///
+/// Имя приложения в именах лог-файлов - это имя буфера без ведущего '/', поэтому
+/// буферы разных процессов можно выводить в одну директорию: @a Rotator каждого буфера
+/// выбирает и ротирует только свои логи.
+/// Переключение на новый файл происходит только на границе записи (после '\n').
+///
+/// Буфер создает приложение (оно же задает его емкость), которое может запуститься
+/// позже писателя, поэтому отсутствующий буфер - не ошибка: писатель пытается открыть его
+/// при каждом вызове @a drain(), а лог-файл начинает только после открытия буфера.
+///
+/// С @a compress завершенный лог после переключения на новый сжимается gzip
+/// в файл с суффиксом @a Rotator::compressedLogSuffix, и ротация учитывает его наравне с обычными.
+///
+class RingWriter {
+public:
+     RingWriter(
+          const std::string& ringName
+          , const boost::filesystem::path& logDir
+          , std::size_t maxLogSize = Rotator::defaultMaxLogSize
+          , unsigned maxLogFiles = Rotator::defaultMaxLogFiles
+          , bool compress = false
+          );
+
+     RingWriter( const RingWriter& ) = delete;
+     RingWriter& operator=( const RingWriter& ) = delete;
+
+     /// Переносит в файл все, что есть в буфере на данный момент.
+     /// Возвращает false, если буфер был пуст или еще не создан.
+     bool drain();
+
+     const std::string& ringName() const noexcept { return ringName_; }
+
+     /// Признак того, что буфер открыт
+     bool attached() const noexcept { return static_cast< bool >( ring_ ); }
+
+private:
+     bool attach();
+     void write( const char* s, std::size_t n );
+     void startLoggingInto( const boost::filesystem::path& path );
+
+     const std::string ringName_;
+     ShmRingPtr ring_;
+     Rotator rotator_;
+     const bool compress_;
+     boost::filesystem::path path_;
+     boost::filesystem::ofstream ofile_;
+     std::size_t size_ = 0u;
+     std::array< char, 64u * 1024u > buffer_;
+};
+
+
+} // namespace tiny_logger
+} // namespace alexen
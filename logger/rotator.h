@@ -22,7 +22,9 @@ inline std::string makeAppName( const char* const* argv )
 
 class Rotator {
 public:
-     static constexpr auto logNamePattern = R"regex(\d{4}-\d{2}-\d{2}_.*_\d{9}.log)regex";
+     /// Логи могут быть сжаты внешним писателем (@a RingWriter) после переключения на новый лог
+     static constexpr auto logNamePattern = R"regex(\d{4}-\d{2}-\d{2}_.*_\d{9}\.log(\.gz)?)regex";
+     static constexpr auto compressedLogSuffix = ".gz";
      static constexpr auto defaultMaxLogSize = 10u * 1024u * 1024u;
      static constexpr auto defaultMaxLogFiles = 25u;
 
@@ -49,7 +51,7 @@ public:
      ///
      boost::filesystem::path getCurrentLogFile() const;
 
-     /// Удаляет старые логи в директории @a logDir, если общее кол-во логов превышает @a maxLogFiles
+     /// Удаляет старые логи (в т.ч. сжатые) в директории @a logDir, если общее кол-во логов превышает @a maxLogFiles
      void rotateLogs();
 
 private:
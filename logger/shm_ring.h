@@ -0,0 +1,131 @@
+/// @file shm_ring.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+#include <string>
+#include <iosfwd>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/iostreams/categories.hpp>
+
+#include <logger/logger.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Кольцевой буфер в разделяемой памяти POSIX (shm_open/mmap) для передачи
+/// готовых записей лога во внешний процесс-писатель (утилита tiny_logger_writer).
+///
+/// Буфер рассчитан на одного писателя и одного читателя: писатель - это
+/// @a Logger одного процесса (записи сериализует его мьютекс), читатель - процесс-писатель.
+/// Для нескольких процессов используйте несколько буферов с разными именами.
+///
+/// Сегмент не удаляется ни деструктором, ни читателем, поэтому записи, сделанные
+/// непосредственно перед падением процесса, остаются в буфере до вычитывания.
+/// Удаляет сегмент только явный вызов @a remove().
+///
+class ShmRing {
+public:
+     static constexpr auto defaultCapacity = 4u * 1024u * 1024u;
+
+     /// Открывает сегмент @a name, создавая его при необходимости.
+     /// Данные уже существующего сегмента (например, оставшиеся после падения процесса) сохраняются.
+     ///
+     /// @note Емкость @a capacity округляется вверх до степени двойки.
+     ///
+     static boost::shared_ptr< ShmRing > create( const std::string& name, std::size_t capacity = ShmRing::defaultCapacity );
+
+     /// Открывает существующий сегмент @a name
+     static boost::shared_ptr< ShmRing > open( const std::string& name );
+
+     /// Удаляет сегмент @a name (уже открытые отображения продолжают работать)
+     static void remove( const std::string& name );
+
+     ShmRing( const ShmRing& ) = delete;
+     ShmRing& operator=( const ShmRing& ) = delete;
+     ~ShmRing();
+
+     const std::string& name() const noexcept { return name_; }
+     std::size_t capacity() const noexcept { return capacity_; }
+
+     /// Записывает в буфер @a n байт целиком либо, если места не хватает,
+     /// не записывает ничего (отброшенные байты учитываются в @a dropped()).
+     /// Никогда не блокируется.
+     bool write( const char* s, std::size_t n ) noexcept;
+
+     /// Читает из буфера не более @a n байт и возвращает кол-во прочитанных
+     std::size_t read( char* s, std::size_t n ) noexcept;
+
+     /// Возвращает кол-во байт, отброшенных из-за переполнения буфера
+     std::size_t dropped() const noexcept;
+
+private:
+     struct Header;
+
+     ShmRing( const std::string& name, void* addr, std::size_t mappedSize );
+
+     const std::string name_;
+     void* const addr_;
+     const std::size_t mappedSize_;
+     Header* const header_;
+     char* const data_;
+     const std::size_t capacity_;
+};
+
+
+using ShmRingPtr = boost::shared_ptr< ShmRing >;
+
+
+/// Устройство Boost.Iostreams для записи в @a ShmRing.
+///
+/// Записи попадают в буфер целиком или не попадают вовсе: данные копятся в устройстве
+/// и передаются в буфер одним вызовом @a ShmRing::write() при сбросе потока, который
+/// @a Logger выполняет после каждой записи. Иначе запись длиннее буфера потока (4 Кб)
+/// приходила бы по частям, и при переполнении часть записи могла быть отброшена.
+///
+class ShmRingSink {
+public:
+     using char_type = char;
+     struct category : boost::iostreams::sink_tag, boost::iostreams::flushable_tag {};
+
+     explicit ShmRingSink( ShmRingPtr ring ) : ring_{ ring } {}
+
+     /// Данные, не поместившиеся в буфер, отбрасываются, поэтому
+     /// для потока запись всегда считается успешной
+     std::streamsize write( const char_type* s, std::streamsize n )
+     {
+          pending_.append( s, static_cast< std::size_t >( n ) );
+          /// Такая запись не поместится в буфер в любом случае
+          if( pending_.size() > ring_->capacity() )
+          {
+               flush();
+          }
+          return n;
+     }
+
+     bool flush()
+     {
+          if( !pending_.empty() )
+          {
+               ring_->write( pending_.data(), pending_.size() );
+               pending_.clear();
+          }
+          return true;
+     }
+
+private:
+     ShmRingPtr ring_;
+     std::string pending_;
+};
+
+
+/// Создает выходной поток, пишущий в @a ring, для использования в качестве приемника @a Logger
+OstreamPtr makeShmRingOstream( ShmRingPtr ring );
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -0,0 +1,146 @@
+/// @file asio_sink.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <logger/asio_sink.h>
+
+#include <boost/bind/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/iostreams/stream.hpp>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+AsioSink::AsioSink( const Executor& executor, const int fd, const std::size_t maxQueued )
+     : strand_{ executor }
+     , descriptor_{ executor, fd }
+     , maxQueued_{ maxQueued }
+{}
+
+
+AsioSinkPtr AsioSink::create( const Executor& executor, const int fd, const std::size_t maxQueued )
+{
+     return AsioSinkPtr{ new AsioSink{ executor, fd, maxQueued } };
+}
+
+
+void AsioSink::enqueue( const char* const s, const std::size_t n )
+{
+     boost::lock_guard< boost::mutex > lock{ mutex_ };
+     if( error_ || pending_.size() + n > maxQueued_ )
+     {
+          dropped_ += n;
+          return;
+     }
+     pending_.append( s, n );
+     enqueued_ += n;
+     if( !writing_ )
+     {
+          writing_ = true;
+          boost::asio::post( strand_, boost::bind( &AsioSink::startWrite, shared_from_this() ) );
+     }
+}
+
+
+std::size_t AsioSink::dropped() const noexcept
+{
+     boost::lock_guard< boost::mutex > lock{ mutex_ };
+     return dropped_;
+}
+
+
+void AsioSink::addFlushWaiter( FlushWaiter&& waiter )
+{
+     boost::system::error_code ec;
+     {
+          boost::lock_guard< boost::mutex > lock{ mutex_ };
+          if( !error_ && written_ < enqueued_ )
+          {
+               waiters_.emplace_back( enqueued_, std::move( waiter ) );
+               return;
+          }
+          ec = error_;
+     }
+     waiter( ec );
+}
+
+
+/// Выполняется только на strand, поэтому одновременно выводится не более одного буфера.
+/// Обмен буферами местами позволяет не выделять память заново на каждый вывод.
+void AsioSink::startWrite()
+{
+     {
+          boost::lock_guard< boost::mutex > lock{ mutex_ };
+          if( pending_.empty() )
+          {
+               writing_ = false;
+               return;
+          }
+          inflight_.swap( pending_ );
+     }
+     boost::asio::async_write(
+          descriptor_
+          , boost::asio::buffer( inflight_ )
+          , boost::asio::bind_executor(
+               strand_
+               , boost::bind(
+                    &AsioSink::onWritten
+                    , shared_from_this()
+                    , boost::placeholders::_1
+                    , boost::placeholders::_2
+                    )
+               )
+          );
+}
+
+
+void AsioSink::onWritten( const boost::system::error_code& ec, const std::size_t n )
+{
+     std::list< std::pair< std::size_t, FlushWaiter > > done;
+     {
+          boost::lock_guard< boost::mutex > lock{ mutex_ };
+          written_ += n;
+          if( ec )
+          {
+               /// После ошибки вывода все последующие данные отбрасываются
+               error_ = ec;
+               dropped_ += inflight_.size() - n + pending_.size();
+               pending_.clear();
+               writing_ = false;
+               done.swap( waiters_ );
+          }
+          else
+          {
+               /// Ожидающие упорядочены по возрастанию кол-ва байт, которые должны быть выведены
+               while( !waiters_.empty() && waiters_.front().first <= written_ )
+               {
+                    done.splice( done.end(), waiters_, waiters_.begin() );
+               }
+          }
+          inflight_.clear();
+     }
+     for( auto&& waiter: done )
+     {
+          waiter.second( ec );
+     }
+     if( !ec )
+     {
+          startWrite();
+     }
+}
+
+
+OstreamPtr makeAsioOstream( AsioSinkPtr sink )
+{
+     return boost::make_shared< boost::iostreams::stream< AsioSinkDevice > >( AsioSinkDevice{ sink } );
+}
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include <boost/make_shared.hpp>
+#include <boost/utility/in_place_factory.hpp>
 #include <boost/utility/string_view.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -61,6 +62,30 @@ inline std::ostream& operator<<( std::ostream& os, const ThreadId_& )
 }
 
 
+/// Устройство для записи во внешний приемник.
+///
+/// Поток, добавленный в цепочку напрямую, не сбрасывается при сбросе цепочки
+/// и держит записи в своем буфере. Это устройство сбрасывает приемник вместе с цепочкой,
+/// т.е. на каждом переносе строки в конце записи.
+struct FlushingOstreamSink {
+     using char_type = char;
+     struct category : boost::iostreams::sink_tag, boost::iostreams::flushable_tag {};
+
+     std::streamsize write( const char_type* s, std::streamsize n )
+     {
+          os->write( s, n );
+          return n;
+     }
+
+     bool flush()
+     {
+          return static_cast< bool >( os->flush() );
+     }
+
+     std::ostream* os;
+};
+
+
 } // namespace impl
 
 
@@ -77,16 +102,43 @@ inline std::ostream& operator<<( std::ostream& os, const Level level )
 }
 
 
+/// Уровень для вывода через @a LoggerRecord: оператор вывода @a Level объявлен
+/// в безымянном пространстве имен и из шаблона @a LoggerRecord::operator<<() не виден
+struct LevelText {
+     Level level;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const LevelText& text )
+{
+     return os << text.level;
+}
+
+
+/// Выводит кол-во отброшенных записей по уровням: " <debug> N <info> M"
+struct ShedStatText {
+     const OverloadController::ShedStat& stat;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const ShedStatText& text )
+{
+     for( auto level = Debug; level < Warn; level = static_cast< Level >( level + 1 ) )
+     {
+          os << ' ' << level << ' ' << text.stat[ level ];
+     }
+     return os;
+}
+
+
 } // namespace {unnamed}
 
 
 /// Даже **не** сохраняем значение @a level для экономии памяти!
-LoggerRecord::LoggerRecord( boost::unique_lock< boost::mutex >&& lock, std::ostream& os, const Level level )
+LoggerRecord::LoggerRecord( boost::unique_lock< boost::timed_mutex >&& lock, std::ostream& os, const Level level )
      : lock_{ std::move( lock ) }
-     , os_{ os }
+     , os_{ boost::addressof( os ) }
 {
      static constexpr boost::string_view tail = ": ";
-     os_ << impl::timestamp << ' ' << impl::threadId << ' ' << level << tail;
+     *os_ << impl::timestamp << ' ' << impl::threadId << ' ' << level << tail;
 }
 
 
@@ -94,7 +146,10 @@ LoggerRecord::LoggerRecord( boost::unique_lock< boost::mutex >&& lock, std::ostr
 /// с переносом строки
 LoggerRecord::~LoggerRecord()
 {
-     os_ << std::endl;
+     if( os_ )
+     {
+          *os_ << std::endl;
+     }
 }
 
 
@@ -102,19 +157,53 @@ Logger::Logger(
      const std::string& appName
      , const boost::filesystem::path& logDir
      , OstreamPtr console
+     , const std::size_t maxLogSize
+     , const unsigned maxLogFiles
+     , const boost::optional< OverloadController::Settings > overload
 )
-     : rotator_{ appName, logDir }
+     : rotator_{ boost::in_place( appName, logDir, maxLogSize, maxLogFiles ) }
      , console_{ console }
 {
+     if( overload )
+     {
+          overload_.emplace( *overload );
+     }
      prepareLogDirectory();
      setFilteringStreams();
-     startLoggingInto( boost::unique_lock< boost::mutex >{ mutex_ }, rotator_.getCurrentLogFile() );
+     startLoggingInto( boost::unique_lock< boost::timed_mutex >{ mutex_ }, rotator_->getCurrentLogFile() );
+}
+
+
+Logger::Logger( OstreamPtr sink, OstreamPtr console, const boost::optional< OverloadController::Settings > overload )
+     : console_{ console }
+     , sink_{ sink }
+{
+     BOOST_ASSERT_MSG( sink_, "Sink stream required" );
+     if( overload )
+     {
+          overload_.emplace( *overload );
+     }
+     setFilteringStreams();
+}
+
+
+/// Записи, отброшенные после последнего шага восстановления, иначе
+/// не попали бы ни в одну сводку
+Logger::~Logger()
+{
+     OverloadController::ShedStat stat;
+     if( !overload_ || !overload_->takeShedStat( stat ) )
+     {
+          return;
+     }
+     const boost::unique_lock< boost::timed_mutex > lock{ mutex_ };
+     LoggerRecord{ {}, olog_, Warn } << "logger dropped records:" << ShedStatText{ stat };
 }
 
 
 void Logger::prepareLogDirectory()
 {
-     boost::filesystem::create_directories( rotator_.logDir() );
+     boost::filesystem::create_directories( rotator_->logDir() );
 }
 
 
@@ -125,26 +214,114 @@ void Logger::setFilteringStreams()
           olog_.push( boost::iostreams::tee_filter< std::ostream >{ *console_ } );
      }
      olog_.push( boost::ref( counter_ ) );
-     olog_.push( ofile_ );
+     if( sink_ )
+     {
+          olog_.push( impl::FlushingOstreamSink{ sink_.get() } );
+     }
+     else
+     {
+          olog_.push( ofile_ );
+     }
 }
 
 
-void Logger::startLoggingInto( const boost::unique_lock< boost::mutex >&, const boost::filesystem::path& path )
+void Logger::startLoggingInto( const boost::unique_lock< boost::timed_mutex >&, const boost::filesystem::path& path )
 {
      ofile_.close();
-     rotator_.rotateLogs();
+     rotator_->rotateLogs();
      updateStat();
      counter_.reset( boost::filesystem::exists( path ) ? boost::filesystem::file_size( path ) : 0u );
      ofile_.open( path, std::ios_base::out | std::ios_base::app );
 }
 
 
+/// Записи ниже @a Warn не ждут зависший вывод: если за @a OverloadController::maxLockWait()
+/// ни одна запись не получила мьютекс (не изменилось @a totalRecords_), вывод считается
+/// зависшим и запись отбрасывается. Пока записи выводятся, ожидание продолжается,
+/// поэтому обычная конкуренция потоков за мьютекс записи не теряет.
+/// Записи уровня @a Warn и выше не отбрасываются и ждут мьютекс без ограничения.
+///
+/// Возвращает false, если запись отброшена.
+bool Logger::waitForLock( boost::unique_lock< boost::timed_mutex >& lock, const Level level )
+{
+     if( !overload_ || level >= Warn )
+     {
+          lock.lock();
+          return true;
+     }
+     const boost::chrono::nanoseconds maxLockWait{
+          std::chrono::duration_cast< std::chrono::nanoseconds >( overload_->maxLockWait() ).count() };
+     auto progress = totalRecords_.load( boost::memory_order_relaxed );
+     while( !lock.try_lock_for( maxLockWait ) )
+     {
+          const auto current = totalRecords_.load( boost::memory_order_relaxed );
+          if( current == progress )
+          {
+               overload_->onStall( level );
+               return false;
+          }
+          progress = current;
+     }
+     return true;
+}
+
+
+/// Поток, обнаруживший зависание, не владеет мьютексом и писать в лог не может,
+/// поэтому о поднятии уровня сообщает первая запись, получившая мьютекс после него.
+///
+/// Записи логгера о перегрузке пишутся с пустой блокировкой,
+/// т.к. мьютекс уже захвачен вызывающей стороной.
+void Logger::reportOverload( const boost::unique_lock< boost::timed_mutex >& )
+{
+     const auto level = overload_->minLevel();
+     if( level > reportedLevel_ )
+     {
+          reportedLevel_ = level;
+          LoggerRecord{ {}, olog_, Warn }
+               << "logger output is stalled, records below " << LevelText{ level } << " are dropped";
+          return;
+     }
+     OverloadController::ShedStat stat;
+     if( !overload_->tryRestore( stat ) )
+     {
+          return;
+     }
+     reportedLevel_ = static_cast< Level >( level - 1 );
+     LoggerRecord record{ {}, olog_, Warn };
+     record << "logger overload subsided, dropped records:" << ShedStatText{ stat };
+     if( reportedLevel_ > Debug )
+     {
+          record << ", records below " << LevelText{ reportedLevel_ } << " are still dropped";
+     }
+     else
+     {
+          record << ", all levels restored";
+     }
+}
+
+
 LoggerRecord Logger::operator()( const Level level )
 {
-     boost::unique_lock< boost::mutex > lock{ mutex_ };
-     if( counter_.chars() > rotator_.maxLogSize() )
+     if( overload_ && overload_->shed( level ) )
+     {
+          return LoggerRecord{};
+     }
+     boost::unique_lock< boost::timed_mutex > lock{ mutex_, boost::try_to_lock };
+     if( !lock.owns_lock() && !waitForLock( lock, level ) )
+     {
+          return LoggerRecord{};
+     }
+     if( overload_ && overload_->degraded() )
+     {
+          reportOverload( lock );
+          if( overload_->shed( level ) )
+          {
+               return LoggerRecord{};
+          }
+     }
+     if( rotator_ && counter_.chars() > rotator_->maxLogSize() )
      {
-          startLoggingInto( lock, rotator_.generateNextLogName() );
+          startLoggingInto( lock, rotator_->generateNextLogName() );
      }
      ++totalRecords_;
      return LoggerRecord{ std::move( lock ), olog_, level };
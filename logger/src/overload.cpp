@@ -0,0 +1,103 @@
+/// @file overload.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <logger/overload.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+OverloadController::OverloadController( const Settings& settings )
+     : settings_{ settings }
+     , lastRaise_{ ( Clock::now() - settings.raiseDelay ).time_since_epoch().count() }
+{}
+
+
+bool OverloadController::pressureSubsided( const Clock::time_point now ) const noexcept
+{
+     return now.time_since_epoch().count() - lastPressure_.load( boost::memory_order_relaxed )
+          >= settings_.restoreDelay.count();
+}
+
+
+/// Если давление уже спало, запись не отбрасываем: она пройдет через мьютекс логгера
+/// и запустит восстановление уровней в @a tryRestore(). Иначе уровни восстанавливались бы
+/// только записями уровня @a Warn и выше, которых может и не быть.
+bool OverloadController::shedSlow( const Level level ) noexcept
+{
+     if( pressureSubsided( Clock::now() ) )
+     {
+          return false;
+     }
+     shed_[ level ].fetch_add( 1u, boost::memory_order_relaxed );
+     totalShed_.fetch_add( 1u, boost::memory_order_relaxed );
+     return true;
+}
+
+
+/// Вызывается без мьютекса логгера (он как раз занят зависшим выводом),
+/// поэтому уровень меняется только через compare_exchange.
+bool OverloadController::onStall( const Level level ) noexcept
+{
+     shed_[ level ].fetch_add( 1u, boost::memory_order_relaxed );
+     totalShed_.fetch_add( 1u, boost::memory_order_relaxed );
+
+     const auto now = Clock::now().time_since_epoch().count();
+     lastPressure_.store( now, boost::memory_order_relaxed );
+
+     /// Уровень поднимает только тот поток, которому удалось сдвинуть время последнего поднятия
+     auto lastRaise = lastRaise_.load( boost::memory_order_relaxed );
+     if( now - lastRaise < settings_.raiseDelay.count()
+          || !lastRaise_.compare_exchange_strong( lastRaise, now, boost::memory_order_relaxed ) )
+     {
+          return false;
+     }
+     auto minLevel = this->minLevel();
+     while( minLevel < Warn )
+     {
+          if( minLevel_.compare_exchange_weak( minLevel, static_cast< Level >( minLevel + 1 ), boost::memory_order_relaxed ) )
+          {
+               return true;
+          }
+     }
+     return false;
+}
+
+
+bool OverloadController::tryRestore( ShedStat& stat ) noexcept
+{
+     const auto now = Clock::now();
+     if( !degraded() || !pressureSubsided( now ) )
+     {
+          return false;
+     }
+     /// Уровень мог быть поднят параллельно, тогда восстанавливать рано
+     auto level = minLevel();
+     if( !minLevel_.compare_exchange_strong( level, static_cast< Level >( level - 1 ), boost::memory_order_relaxed ) )
+     {
+          return false;
+     }
+     /// Каждый следующий шаг восстановления также ждет @a restoreDelay
+     lastPressure_.store( now.time_since_epoch().count(), boost::memory_order_relaxed );
+
+     takeShedStat( stat );
+     return true;
+}
+
+
+bool OverloadController::takeShedStat( ShedStat& stat ) noexcept
+{
+     bool any = false;
+     for( auto i = 0u; i < stat.size(); ++i )
+     {
+          stat[ i ] = shed_[ i ].exchange( 0u, boost::memory_order_relaxed );
+          any = any || stat[ i ];
+     }
+     return any;
+}
+
+
+} // namespace tiny_logger
+} // namespace alexen
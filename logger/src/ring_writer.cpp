@@ -0,0 +1,159 @@
+/// @file ring_writer.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <logger/ring_writer.h>
+
+#include <stdexcept>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/filesystem/operations.hpp>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+namespace {
+namespace impl {
+
+
+/// Сжимает лог @a path в файл рядом с ним и удаляет исходный лог. Сжатие идет во временный
+/// файл, имя которого не подходит под шаблон логов, поэтому прерванное сжатие не оставляет
+/// битых логов. Сжатый лог получает время изменения исходного, чтобы порядок логов
+/// при ротации не изменился. Сжатие выполняется в потоке вывода буфера, поэтому
+/// используется самый быстрый уровень сжатия.
+void compress( const boost::filesystem::path& path )
+{
+     auto compressed = path;
+     compressed += Rotator::compressedLogSuffix;
+     auto temporary = compressed;
+     temporary += ".part";
+     try
+     {
+          boost::filesystem::ifstream ifile{ path, std::ios_base::binary };
+          boost::filesystem::ofstream ofile{ temporary, std::ios_base::binary };
+          if( !ifile || !ofile )
+          {
+               throw std::runtime_error{ "cannot open log " + path.string() + " for compression" };
+          }
+          boost::iostreams::filtering_ostream os;
+          os.push( boost::iostreams::gzip_compressor{ boost::iostreams::gzip::best_speed } );
+          os.push( ofile );
+          /// Закрывает и @a os, дописывая в сжатый лог окончание gzip
+          boost::iostreams::copy( ifile, os );
+          if( !ofile.flush() )
+          {
+               throw std::runtime_error{ "cannot compress log " + path.string() };
+          }
+          ofile.close();
+          boost::filesystem::last_write_time( temporary, boost::filesystem::last_write_time( path ) );
+          boost::filesystem::rename( temporary, compressed );
+     }
+     catch( const std::exception& )
+     {
+          /// Лог остается несжатым: ротация учитывает его так же, как и сжатый
+          boost::system::error_code ec;
+          boost::filesystem::remove( temporary, ec );
+          return;
+     }
+     boost::filesystem::remove( path );
+}
+
+
+} // namespace impl
+} // namespace {unnamed}
+
+
+RingWriter::RingWriter(
+     const std::string& ringName
+     , const boost::filesystem::path& logDir
+     , const std::size_t maxLogSize
+     , const unsigned maxLogFiles
+     , const bool compress
+)
+     : ringName_{ ringName }
+     , rotator_{ ringName.substr( ringName.find_first_not_of( '/' ) ), logDir, maxLogSize, maxLogFiles }
+     , compress_{ compress }
+{
+     attach();
+}
+
+
+bool RingWriter::drain()
+{
+     if( !ring_ && !attach() )
+     {
+          return false;
+     }
+     bool any = false;
+     while( const auto n = ring_->read( buffer_.data(), buffer_.size() ) )
+     {
+          any = true;
+          write( buffer_.data(), n );
+     }
+     if( any )
+     {
+          ofile_.flush();
+     }
+     return any;
+}
+
+
+/// Буфер может отсутствовать или еще создаваться приложением (тогда он не опознается как буфер лога),
+/// в обоих случаях попытка будет повторена при следующем вызове @a drain()
+bool RingWriter::attach()
+{
+     try
+     {
+          ring_ = ShmRing::open( ringName_ );
+     }
+     catch( const std::exception& )
+     {
+          return false;
+     }
+     startLoggingInto( rotator_.getCurrentLogFile() );
+     return true;
+}
+
+
+void RingWriter::write( const char* s, const std::size_t n )
+{
+     const boost::string_view chunk{ s, n };
+     const auto eol = chunk.find_last_of( '\n' );
+     if( eol == boost::string_view::npos )
+     {
+          ofile_.write( s, n );
+          size_ += n;
+          return;
+     }
+     ofile_.write( s, eol + 1u );
+     size_ += eol + 1u;
+     if( size_ > rotator_.maxLogSize() )
+     {
+          startLoggingInto( rotator_.generateNextLogName() );
+     }
+     ofile_.write( s + eol + 1u, n - eol - 1u );
+     size_ += n - eol - 1u;
+}
+
+
+void RingWriter::startLoggingInto( const boost::filesystem::path& path )
+{
+     ofile_.close();
+     if( compress_ && !path_.empty() )
+     {
+          impl::compress( path_ );
+     }
+     rotator_.rotateLogs();
+     path_ = path;
+     size_ = boost::filesystem::exists( path ) ? boost::filesystem::file_size( path ) : 0u;
+     ofile_.open( path, std::ios_base::out | std::ios_base::app );
+}
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -28,11 +28,16 @@ namespace {
 namespace impl {
 
 
+/// Время изменения файла известно лишь с точностью до секунды, и при частой ротации
+/// у нескольких логов оно совпадает. В этом случае более новым считается лог с большим
+/// именем: имена, сгенерированные @a generateNextLogName(), упорядочены по времени создания.
 struct LastWriteTimeGreater
 {
      bool operator()( const boost::filesystem::path& lhs, const boost::filesystem::path& rhs ) const
      {
-          return boost::filesystem::last_write_time( lhs ) > boost::filesystem::last_write_time( rhs );
+          const auto lhsTime = boost::filesystem::last_write_time( lhs );
+          const auto rhsTime = boost::filesystem::last_write_time( rhs );
+          return lhsTime > rhsTime || ( lhsTime == rhsTime && lhs.filename() > rhs.filename() );
      }
 };
 using FilePathSet = std::multiset< boost::filesystem::path, LastWriteTimeGreater >;
@@ -54,6 +59,34 @@ inline bool doesMatchNamePattern( const boost::filesystem::directory_entry& entr
 }
 
 
+/// Лог принадлежит приложению @a appName, если сразу после даты идет имя приложения,
+/// а за ним только время создания. Иначе логи приложений, пишущих в одну директорию
+/// (например, "app" и "app_x"), смешивались бы при выборе текущего лога и при ротации.
+inline bool belongsToApp( const boost::filesystem::directory_entry& entry, const std::string& appName )
+{
+     static constexpr auto datePrefixLen = sizeof( "YYYY-MM-DD_" ) - 1;
+     static const boost::regex creationTime{ R"regex((\d{6}_)?\d{9}\.log(\.gz)?)regex" };
+
+     const auto filename = entry.path().filename().string();
+     const boost::string_view rest{ filename };
+     return rest.size() > datePrefixLen + appName.size()
+          && rest.substr( datePrefixLen, appName.size() ) == appName
+          && rest[ datePrefixLen + appName.size() ] == '_'
+          && boost::regex_match(
+               filename.begin() + datePrefixLen + appName.size() + 1u
+               , filename.end()
+               , creationTime
+               );
+}
+
+
+/// Сжатый лог уже завершен, и дописывать в него нельзя
+inline bool isCompressed( const boost::filesystem::directory_entry& entry )
+{
+     return entry.path().extension() == alexen::tiny_logger::Rotator::compressedLogSuffix;
+}
+
+
 inline bool isLastWriteTimeToday( const boost::filesystem::directory_entry& entry )
 {
      return boost::posix_time::from_time_t( boost::filesystem::last_write_time( entry ) ).date()
@@ -86,8 +119,9 @@ boost::filesystem::path Rotator::generateNextLogName() const
      /// ISO C `broken-down time' structure
      static tm bdt = {};
      static timespec tmspec = {};
-     static constexpr auto bufferLen = sizeof( "YYYY-MM-DD" ) - 1;
-     static char buffer[ bufferLen ] = {};
+     static constexpr auto bufferLen = sizeof( "YYYY-MM-DD_HHMMSS" ) - 1;
+     static constexpr auto dateLen = sizeof( "YYYY-MM-DD" ) - 1;
+     static char buffer[ bufferLen + 1 ] = {}; /// Плюс один нулевой символ
      thread_local static std::ostringstream oss;
 
      timespec_get( &tmspec, TIME_UTC );
@@ -96,16 +130,22 @@ boost::filesystem::path Rotator::generateNextLogName() const
      snprintf(
           buffer
           , bufferLen + 1
-          , "%04d-%02d-%02d"
+          , "%04d-%02d-%02d_%02d%02d%02d"
           , bdt.tm_year + 1900
           , bdt.tm_mon + 1
           , bdt.tm_mday
+          , bdt.tm_hour
+          , bdt.tm_min
+          , bdt.tm_sec
           );
 
+     /// Время создания (с точностью до наносекунд) идет после имени приложения, поэтому
+     /// имена логов одного приложения упорядочены по времени создания
      oss.str( {} );
-     oss << boost::string_view{ buffer, bufferLen }
+     oss << boost::string_view{ buffer, dateLen }
           << sep
           << appName_
+          << boost::string_view{ buffer + dateLen, bufferLen - dateLen }
           << sep
           << std::setw( 9 ) << std::setfill( '0' ) << tmspec.tv_nsec
           << suffix;
@@ -122,10 +162,12 @@ boost::filesystem::path Rotator::getCurrentLogFile() const
           , {}
           , std::inserter( logFiles, logFiles.end() )
           ,
-          []( const boost::filesystem::directory_entry& entry )
+          [ this ]( const boost::filesystem::directory_entry& entry )
           {
                return impl::isRegularFile( entry )
                     && impl::doesMatchNamePattern( entry )
+                    && impl::belongsToApp( entry, appName_ )
+                    && !impl::isCompressed( entry )
                     && impl::isLastWriteTimeToday( entry );
           });
 
@@ -149,10 +191,11 @@ void Rotator::rotateLogs()
           , {}
           , std::inserter( logFiles, logFiles.end() )
           ,
-          []( const boost::filesystem::directory_entry& entry )
+          [ this ]( const boost::filesystem::directory_entry& entry )
           {
                return impl::isRegularFile( entry )
-                    && impl::doesMatchNamePattern( entry );
+                    && impl::doesMatchNamePattern( entry )
+                    && impl::belongsToApp( entry, appName_ );
           });
 
      if( logFiles.size() > maxLogFiles_ )
@@ -0,0 +1,227 @@
+/// @file shm_ring.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <logger/shm_ring.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/iostreams/stream.hpp>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Заголовок сегмента. Лежит в разделяемой памяти, поэтому все поля, которые
+/// меняются после инициализации, - атомарные без блокировок.
+///
+/// Позиции @a head и @a tail монотонно растут, а в буфер отображаются по модулю емкости.
+/// Пишет @a head только писатель, а @a tail - только читатель.
+struct ShmRing::Header {
+     static constexpr std::uint64_t expectedMagic = 0x676e69526f6c7474; /// "ttloRing"
+
+     boost::atomic< std::uint64_t > magic;
+     std::uint64_t capacity;
+     boost::atomic< std::uint64_t > dropped;
+     alignas( 64 ) boost::atomic< std::uint64_t > head;
+     alignas( 64 ) boost::atomic< std::uint64_t > tail;
+};
+
+
+namespace {
+namespace impl {
+
+
+/// Данные начинаются с отдельной страницы сразу за заголовком
+constexpr std::size_t dataOffset = 4096u;
+
+static_assert( boost::atomic< std::uint64_t >::is_always_lock_free, "Shared memory requires lock-free atomics" );
+
+
+[[noreturn]] void throwSystemError( const std::string& what )
+{
+     throw boost::system::system_error{ errno, boost::system::system_category(), what };
+}
+
+
+/// Дескриптор, закрываемый при выходе из области видимости
+struct Fd {
+     explicit Fd( int fd ) : fd{ fd } {}
+     ~Fd() { if( fd >= 0 ) ::close( fd ); }
+     const int fd;
+};
+
+
+inline std::size_t roundUpToPowerOfTwo( std::size_t n )
+{
+     std::size_t result = 1u;
+     while( result < n )
+     {
+          result <<= 1u;
+     }
+     return result;
+}
+
+
+void* map( const std::string& name, const int fd, const std::size_t size )
+{
+     void* const addr = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+     if( addr == MAP_FAILED )
+     {
+          throwSystemError( "mmap " + name );
+     }
+     return addr;
+}
+
+
+std::size_t segmentSize( const std::string& name, const int fd )
+{
+     struct stat st = {};
+     if( ::fstat( fd, &st ) != 0 )
+     {
+          throwSystemError( "fstat " + name );
+     }
+     return static_cast< std::size_t >( st.st_size );
+}
+
+
+} // namespace impl
+} // namespace {unnamed}
+
+
+ShmRing::ShmRing( const std::string& name, void* const addr, const std::size_t mappedSize )
+     : name_{ name }
+     , addr_{ addr }
+     , mappedSize_{ mappedSize }
+     , header_{ static_cast< Header* >( addr ) }
+     , data_{ static_cast< char* >( addr ) + impl::dataOffset }
+     , capacity_{ mappedSize - impl::dataOffset }
+{
+     static_assert( sizeof( Header ) <= impl::dataOffset, "Header does not fit into the first page" );
+
+     if( header_->magic.load( boost::memory_order_acquire ) != Header::expectedMagic
+          || header_->capacity != capacity_ )
+     {
+          ::munmap( addr_, mappedSize_ );
+          throw std::runtime_error{ "shared memory segment " + name + " is not a log ring" };
+     }
+}
+
+
+ShmRing::~ShmRing()
+{
+     ::munmap( addr_, mappedSize_ );
+}
+
+
+ShmRingPtr ShmRing::create( const std::string& name, const std::size_t capacity )
+{
+     const impl::Fd shm{ ::shm_open( name.c_str(), O_RDWR | O_CREAT, 0600 ) };
+     if( shm.fd < 0 )
+     {
+          impl::throwSystemError( "shm_open " + name );
+     }
+
+     auto size = impl::segmentSize( name, shm.fd );
+     if( size == 0u )
+     {
+          /// Новый сегмент: ftruncate заполняет его нулями, что соответствует
+          /// нулевым значениям атомарных полей заголовка
+          size = impl::dataOffset + impl::roundUpToPowerOfTwo( std::max< std::size_t >( capacity, 1u ) );
+          if( ::ftruncate( shm.fd, static_cast< off_t >( size ) ) != 0 )
+          {
+               impl::throwSystemError( "ftruncate " + name );
+          }
+          auto* const header = static_cast< Header* >( impl::map( name, shm.fd, size ) );
+          header->capacity = size - impl::dataOffset;
+          header->magic.store( Header::expectedMagic, boost::memory_order_release );
+          return ShmRingPtr{ new ShmRing{ name, header, size } };
+     }
+     return ShmRingPtr{ new ShmRing{ name, impl::map( name, shm.fd, size ), size } };
+}
+
+
+ShmRingPtr ShmRing::open( const std::string& name )
+{
+     const impl::Fd shm{ ::shm_open( name.c_str(), O_RDWR, 0 ) };
+     if( shm.fd < 0 )
+     {
+          impl::throwSystemError( "shm_open " + name );
+     }
+     const auto size = impl::segmentSize( name, shm.fd );
+     if( size <= impl::dataOffset )
+     {
+          throw std::runtime_error{ "shared memory segment " + name + " is not a log ring" };
+     }
+     return ShmRingPtr{ new ShmRing{ name, impl::map( name, shm.fd, size ), size } };
+}
+
+
+void ShmRing::remove( const std::string& name )
+{
+     if( ::shm_unlink( name.c_str() ) != 0 && errno != ENOENT )
+     {
+          impl::throwSystemError( "shm_unlink " + name );
+     }
+}
+
+
+bool ShmRing::write( const char* const s, const std::size_t n ) noexcept
+{
+     const auto head = header_->head.load( boost::memory_order_relaxed );
+     const auto tail = header_->tail.load( boost::memory_order_acquire );
+     if( n > capacity_ - ( head - tail ) )
+     {
+          header_->dropped.fetch_add( n, boost::memory_order_relaxed );
+          return false;
+     }
+     const auto pos = head & ( capacity_ - 1u );
+     const auto first = std::min( n, capacity_ - pos );
+     std::memcpy( data_ + pos, s, first );
+     std::memcpy( data_, s + first, n - first );
+     header_->head.store( head + n, boost::memory_order_release );
+     return true;
+}
+
+
+std::size_t ShmRing::read( char* const s, const std::size_t n ) noexcept
+{
+     const auto tail = header_->tail.load( boost::memory_order_relaxed );
+     const auto head = header_->head.load( boost::memory_order_acquire );
+     const auto total = std::min< std::size_t >( n, head - tail );
+     const auto pos = tail & ( capacity_ - 1u );
+     const auto first = std::min( total, capacity_ - pos );
+     std::memcpy( s, data_ + pos, first );
+     std::memcpy( s + first, data_, total - first );
+     header_->tail.store( tail + total, boost::memory_order_release );
+     return total;
+}
+
+
+std::size_t ShmRing::dropped() const noexcept
+{
+     return header_->dropped.load( boost::memory_order_relaxed );
+}
+
+
+OstreamPtr makeShmRingOstream( ShmRingPtr ring )
+{
+     return boost::make_shared< boost::iostreams::stream< ShmRingSink > >( ShmRingSink{ ring } );
+}
+
+
+} // namespace tiny_logger
+} // namespace alexen
@@ -0,0 +1,194 @@
+/// @file timing.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <logger/timing.h>
+
+#include <limits>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#    include <cpuid.h>
+#endif
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+namespace {
+namespace impl {
+
+
+/// Выводит длительность в микросекундах
+struct Microseconds {
+     explicit Microseconds( const std::chrono::nanoseconds ns ) : ns{ ns } {}
+     const std::chrono::nanoseconds ns;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const Microseconds& us )
+{
+     return os << us.ns.count() / 1000. << " us";
+}
+
+
+/// Номер интервала гистограммы - это кол-во значащих бит замера
+inline unsigned bucketOf( const TscClock::rep ticks ) noexcept
+{
+     return ticks ? 64u - static_cast< unsigned >( __builtin_clzll( ticks ) ) : 0u;
+}
+
+
+} // namespace impl
+} // namespace {unnamed}
+
+
+TscClock::Calibration::Calibration() noexcept
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+     /// __get_cpuid() сам проверяет, что расширенная функция 0x80000007 поддерживается
+     unsigned eax = 0u, ebx = 0u, ecx = 0u, edx = 0u;
+     invariantTsc = __get_cpuid( 0x80000007u, &eax, &ebx, &ecx, &edx ) && ( edx & ( 1u << 8u ) );
+     if( !invariantTsc )
+     {
+          return;
+     }
+
+     constexpr auto interval = std::chrono::milliseconds{ 10 };
+
+     const auto startTime = std::chrono::steady_clock::now();
+     const auto startTicks = __rdtsc();
+     auto elapsed = std::chrono::steady_clock::duration::zero();
+     while( elapsed < interval )
+     {
+          elapsed = std::chrono::steady_clock::now() - startTime;
+     }
+     const auto ticks = __rdtsc() - startTicks;
+     ticksPerNanosecond = static_cast< double >( ticks )
+          / std::chrono::duration_cast< std::chrono::nanoseconds >( elapsed ).count();
+#endif
+}
+
+
+std::chrono::nanoseconds TscClock::toDuration( const rep ticks ) noexcept
+{
+     return std::chrono::nanoseconds{ static_cast< std::chrono::nanoseconds::rep >( ticks / calibration().ticksPerNanosecond ) };
+}
+
+
+TscClock::rep TscClock::fromDuration( const std::chrono::nanoseconds duration ) noexcept
+{
+     return static_cast< rep >( duration.count() * calibration().ticksPerNanosecond );
+}
+
+
+ScopeTimer::ScopeTimer(
+     Logger& logger
+     , const std::string_view file
+     , const unsigned line
+     , const char* const name
+     , const std::chrono::nanoseconds threshold
+) noexcept
+     : logger_{ logger }
+     , file_{ file }
+     , line_{ line }
+     , name_{ name }
+     , threshold_{ TscClock::fromDuration( threshold ) }
+     , start_{ TscClock::now() }
+{}
+
+
+ScopeTimer::~ScopeTimer()
+{
+     const auto ticks = TscClock::now() - start_;
+     if( ticks >= threshold_ )
+     {
+          logger_.info() << '(' << file_ << ':' << line_ << ") "
+               << name_ << " took " << impl::Microseconds{ TscClock::toDuration( ticks ) };
+     }
+}
+
+
+TimingStat::TimingStat(
+     const std::string_view file
+     , const unsigned line
+     , const char* const name
+     , const std::chrono::nanoseconds period
+) noexcept
+     : file_{ file }
+     , line_{ line }
+     , name_{ name }
+     , period_{ TscClock::fromDuration( period ) }
+     , lastReport_{ TscClock::now() }
+     , min_{ std::numeric_limits< TscClock::rep >::max() }
+{}
+
+
+void TimingStat::add( const TscClock::rep ticks, Logger& logger )
+{
+     count_.fetch_add( 1u, boost::memory_order_relaxed );
+     sum_.fetch_add( ticks, boost::memory_order_relaxed );
+     histogram_[ impl::bucketOf( ticks ) ].fetch_add( 1u, boost::memory_order_relaxed );
+
+     auto min = min_.load( boost::memory_order_relaxed );
+     while( ticks < min && !min_.compare_exchange_weak( min, ticks, boost::memory_order_relaxed ) );
+     auto max = max_.load( boost::memory_order_relaxed );
+     while( ticks > max && !max_.compare_exchange_weak( max, ticks, boost::memory_order_relaxed ) );
+
+     /// Сводку выводит только тот поток, которому удалось сдвинуть время последней сводки
+     const auto now = TscClock::now();
+     auto last = lastReport_.load( boost::memory_order_relaxed );
+     if( now - last >= period_
+          && lastReport_.compare_exchange_strong( last, now, boost::memory_order_relaxed ) )
+     {
+          report( logger );
+     }
+}
+
+
+/// Счетчики сбрасываются по одному, поэтому замеры, сделанные другими потоками
+/// во время вывода сводки, могут частично попасть в следующий период.
+void TimingStat::report( Logger& logger )
+{
+     const auto count = count_.exchange( 0u, boost::memory_order_relaxed );
+     const auto sum = sum_.exchange( 0u, boost::memory_order_relaxed );
+     const auto min = min_.exchange( std::numeric_limits< TscClock::rep >::max(), boost::memory_order_relaxed );
+     const auto max = max_.exchange( 0u, boost::memory_order_relaxed );
+
+     std::array< std::uint64_t, histogramSize > histogram;
+     for( auto i = 0u; i < histogramSize; ++i )
+     {
+          histogram[ i ] = histogram_[ i ].exchange( 0u, boost::memory_order_relaxed );
+     }
+     if( !count )
+     {
+          return;
+     }
+
+     const auto percentile = [ & ]( const double p )
+     {
+          const auto rank = static_cast< std::uint64_t >( p * count );
+          std::uint64_t seen = 0u;
+          for( auto i = 0u; i < histogramSize; ++i )
+          {
+               seen += histogram[ i ];
+               if( seen > rank )
+               {
+                    /// Верхняя граница интервала, но не больше фактического максимума
+                    return TscClock::toDuration( i < 64u ? std::min( TscClock::rep{ 1u } << i, max ) : max );
+               }
+          }
+          return TscClock::toDuration( max );
+     };
+
+     logger.info() << '(' << file_ << ':' << line_ << ") " << name_
+          << ": count " << count
+          << ", min " << impl::Microseconds{ TscClock::toDuration( min ) }
+          << ", avg " << impl::Microseconds{ TscClock::toDuration( sum / count ) }
+          << ", p50 " << impl::Microseconds{ percentile( .5 ) }
+          << ", p99 " << impl::Microseconds{ percentile( .99 ) }
+          << ", max " << impl::Microseconds{ TscClock::toDuration( max ) };
+}
+
+
+} // namespace tiny_logger
+} // namespace alexen
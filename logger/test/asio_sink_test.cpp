@@ -0,0 +1,172 @@
+/// @file asio_sink_test.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#if defined( BOOST_ASIO_HAS_CO_AWAIT )
+#    include <boost/asio/co_spawn.hpp>
+#    include <boost/asio/detached.hpp>
+#endif
+
+#include <string>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <logger/asio_sink.h>
+
+
+namespace {
+
+
+/// Канал, из которого тест читает то, что вывел приемник
+/// (неблокирующий, чтобы тест не зависал при отсутствии данных)
+struct Pipe {
+     Pipe() { BOOST_REQUIRE( ::pipe2( fds, O_NONBLOCK ) == 0 ); }
+     ~Pipe() { ::close( fds[ 0 ] ); }
+
+     std::string readAvailable()
+     {
+          std::string result;
+          char buffer[ 4096 ];
+          ssize_t n = 0;
+          while( ( n = ::read( fds[ 0 ], buffer, sizeof( buffer ) ) ) > 0 )
+          {
+               result.append( buffer, n );
+          }
+          return result;
+     }
+
+     int fds[ 2 ] = { -1, -1 };
+};
+
+
+} // namespace {unnamed}
+
+
+BOOST_AUTO_TEST_SUITE( AsioSinkTest )
+
+using alexen::tiny_logger::AsioSink;
+
+BOOST_AUTO_TEST_CASE( TestRecordsAreWrittenByEventLoop )
+{
+     Pipe pipe;
+     boost::asio::io_context ioc;
+     const auto sink = AsioSink::create( ioc.get_executor(), pipe.fds[ 1 ] );
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeAsioOstream( sink ) };
+
+     logger.info() << "record " << 1;
+     logger.warn() << "record " << 2;
+
+     bool flushed = false;
+     sink->asyncFlush(
+          [ &flushed ]( const boost::system::error_code& ec )
+          {
+               BOOST_TEST( !ec );
+               flushed = true;
+          });
+
+     /// Пока цикл событий не запущен, в канал ничего не выводится
+     BOOST_TEST( !flushed );
+
+     ioc.run();
+
+     BOOST_TEST( flushed );
+     const auto logged = pipe.readAvailable();
+     BOOST_TEST( boost::algorithm::contains( logged, "<info>: record 1\n" ) );
+     BOOST_TEST( boost::algorithm::ends_with( logged, "<warn>: record 2\n" ) );
+}
+BOOST_AUTO_TEST_CASE( TestQueueOverflowDrops )
+{
+     Pipe pipe;
+     boost::asio::io_context ioc;
+     const auto sink = AsioSink::create( ioc.get_executor(), pipe.fds[ 1 ], 8u );
+
+     sink->enqueue( "0123456789", 10u );
+     sink->enqueue( "0123", 4u );
+     BOOST_TEST( sink->dropped() == 10u );
+
+     ioc.run();
+
+     BOOST_TEST( pipe.readAvailable() == "0123" );
+}
+BOOST_AUTO_TEST_CASE( TestLongRecordsAreQueuedWhole )
+{
+     Pipe pipe;
+     boost::asio::io_context ioc;
+     const auto sink = AsioSink::create( ioc.get_executor(), pipe.fds[ 1 ], 8192u );
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeAsioOstream( sink ) };
+
+     /// Запись длиннее буфера потока попадает в очередь целиком
+     const std::string payload( 5000u, 'x' );
+     logger.info() << payload;
+     BOOST_TEST( sink->dropped() == 0u );
+
+     /// Вторая такая же запись не помещается и отбрасывается целиком
+     logger.info() << payload;
+
+     ioc.run();
+
+     const auto logged = pipe.readAvailable();
+     BOOST_TEST( boost::algorithm::ends_with( logged, payload + '\n' ) );
+     BOOST_TEST( std::count( logged.begin(), logged.end(), '\n' ) == 1 );
+     BOOST_TEST( sink->dropped() == logged.size() );
+}
+BOOST_AUTO_TEST_CASE( TestFlushHandlerKeepsItsContextBusy )
+{
+     Pipe pipe;
+     boost::asio::thread_pool pool{ 1u };
+     boost::asio::io_context ioc;
+     const auto sink = AsioSink::create( pool.get_executor(), pipe.fds[ 1 ] );
+
+     sink->enqueue( "record\n", 7u );
+
+     /// Приемник выводит на пуле, а обработчик привязан к другому контексту,
+     /// у которого кроме ожидания вывода нет никакой работы
+     bool flushed = false;
+     sink->asyncFlush(
+          boost::asio::bind_executor(
+               ioc
+               , [ &flushed ]( const boost::system::error_code& ec )
+               {
+                    BOOST_TEST( !ec );
+                    flushed = true;
+               }));
+
+     ioc.run();
+
+     BOOST_TEST( flushed );
+     BOOST_TEST( pipe.readAvailable() == "record\n" );
+     pool.join();
+}
+#if defined( BOOST_ASIO_HAS_CO_AWAIT )
+BOOST_AUTO_TEST_CASE( TestAwaitableFlush )
+{
+     Pipe pipe;
+     boost::asio::io_context ioc;
+     const auto sink = AsioSink::create( ioc.get_executor(), pipe.fds[ 1 ] );
+
+     bool flushed = false;
+     boost::asio::co_spawn(
+          ioc
+          , [ & ]() -> boost::asio::awaitable< void >
+          {
+               sink->enqueue( "record\n", 7u );
+               co_await alexen::tiny_logger::awaitFlush( sink );
+               flushed = true;
+          }
+          , boost::asio::detached
+          );
+     ioc.run();
+
+     BOOST_TEST( flushed );
+     BOOST_TEST( pipe.readAvailable() == "record\n" );
+}
+#endif
+BOOST_AUTO_TEST_SUITE_END() /// AsioSinkTest
@@ -0,0 +1,5 @@
+/// @file main.cpp
+/// @brief Точка входа модульных тестов (имя модуля задается в CMakeLists.txt)
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
@@ -0,0 +1,252 @@
+/// @file overload_test.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <sstream>
+#include <streambuf>
+#include <condition_variable>
+
+#include <boost/make_shared.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <logger/logger.h>
+#include <logger/overload.h>
+
+
+namespace {
+
+
+/// Буфер, зависающий на выводе до вызова @a release() (имитирует зависший stderr)
+class StallingBuf : public std::streambuf {
+public:
+     void waitStalled()
+     {
+          std::unique_lock< std::mutex > lock{ mutex_ };
+          cv_.wait( lock, [ this ]{ return stalled_; } );
+     }
+
+     void release()
+     {
+          std::lock_guard< std::mutex > lock{ mutex_ };
+          released_ = true;
+          cv_.notify_all();
+     }
+
+protected:
+     std::streamsize xsputn( const char*, const std::streamsize n ) override
+     {
+          stall();
+          return n;
+     }
+
+     int_type overflow( const int_type ch ) override
+     {
+          stall();
+          return traits_type::not_eof( ch );
+     }
+
+private:
+     void stall()
+     {
+          std::unique_lock< std::mutex > lock{ mutex_ };
+          stalled_ = true;
+          cv_.notify_all();
+          cv_.wait( lock, [ this ]{ return released_; } );
+     }
+
+     std::mutex mutex_;
+     std::condition_variable cv_;
+     bool stalled_ = false;
+     bool released_ = false;
+};
+
+
+} // namespace {unnamed}
+
+
+
+BOOST_AUTO_TEST_SUITE( OverloadControllerTest )
+
+using alexen::tiny_logger::OverloadController;
+using alexen::tiny_logger::Debug;
+using alexen::tiny_logger::Info;
+using alexen::tiny_logger::Warn;
+using alexen::tiny_logger::Error;
+
+BOOST_AUTO_TEST_CASE( TestNoSheddingWithoutPressure )
+{
+     OverloadController overload;
+     OverloadController::ShedStat stat = {};
+
+     BOOST_TEST( overload.minLevel() == Debug );
+     BOOST_TEST( !overload.degraded() );
+     BOOST_TEST( !overload.shed( Debug ) );
+     BOOST_TEST( !overload.tryRestore( stat ) );
+     BOOST_TEST( !overload.takeShedStat( stat ) );
+}
+BOOST_AUTO_TEST_CASE( TestLevelsAreRaisedStepByStep )
+{
+     OverloadController overload{ { std::chrono::milliseconds{ 1 }, std::chrono::hours{ 1 }, std::chrono::seconds{ 0 } } };
+
+     BOOST_TEST( overload.onStall( Debug ) );
+     BOOST_TEST( overload.minLevel() == Info );
+     BOOST_TEST( overload.shed( Debug ) );
+     BOOST_TEST( !overload.shed( Info ) );
+
+     BOOST_TEST( overload.onStall( Info ) );
+     BOOST_TEST( overload.minLevel() == Warn );
+     BOOST_TEST( overload.shed( Info ) );
+
+     /// Записи уровня Warn и выше не отбрасываются никогда
+     BOOST_TEST( !overload.onStall( Info ) );
+     BOOST_TEST( overload.minLevel() == Warn );
+     BOOST_TEST( !overload.shed( Warn ) );
+     BOOST_TEST( !overload.shed( Error ) );
+}
+BOOST_AUTO_TEST_CASE( TestRaisesAreRateLimited )
+{
+     const auto raiseDelay = std::chrono::milliseconds{ 20 };
+     OverloadController overload{ { std::chrono::milliseconds{ 1 }, std::chrono::hours{ 1 }, raiseDelay } };
+
+     BOOST_TEST( overload.onStall( Debug ) );
+     BOOST_TEST( overload.minLevel() == Info );
+
+     /// Повторные зависания сразу после поднятия уровня не поднимают его дальше
+     BOOST_TEST( !overload.onStall( Info ) );
+     BOOST_TEST( !overload.onStall( Info ) );
+     BOOST_TEST( overload.minLevel() == Info );
+
+     std::this_thread::sleep_for( std::chrono::milliseconds{ 30 } );
+
+     BOOST_TEST( overload.onStall( Info ) );
+     BOOST_TEST( overload.minLevel() == Warn );
+}
+BOOST_AUTO_TEST_CASE( TestStalledRecordsAreCountedAsShed )
+{
+     OverloadController overload{ { std::chrono::milliseconds{ 1 }, std::chrono::hours{ 1 } } };
+     OverloadController::ShedStat stat = {};
+
+     overload.onStall( Debug );
+     overload.onStall( Info );
+     BOOST_TEST( overload.shed( Debug ) );
+
+     BOOST_TEST( overload.takeShedStat( stat ) );
+     BOOST_TEST( stat[ Debug ] == 2u );
+     BOOST_TEST( stat[ Info ] == 1u );
+     BOOST_TEST( !overload.takeShedStat( stat ) );
+     BOOST_TEST( overload.totalShed() == 3u );
+}
+BOOST_AUTO_TEST_CASE( TestLevelsAreRestoredAfterDelay )
+{
+     const auto restoreDelay = std::chrono::milliseconds{ 20 };
+     OverloadController overload{ { std::chrono::milliseconds{ 1 }, restoreDelay, std::chrono::seconds{ 0 } } };
+     OverloadController::ShedStat stat = {};
+
+     overload.onStall( Debug );
+     overload.onStall( Info );
+     BOOST_TEST( overload.shed( Debug ) );
+     BOOST_TEST( overload.shed( Info ) );
+     BOOST_TEST( !overload.tryRestore( stat ) );
+
+     std::this_thread::sleep_for( std::chrono::milliseconds{ 30 } );
+
+     /// После спада давления запись не отбрасывается, чтобы дойти до восстановления
+     BOOST_TEST( !overload.shed( Debug ) );
+     BOOST_TEST( overload.tryRestore( stat ) );
+     BOOST_TEST( overload.minLevel() == Info );
+     BOOST_TEST( stat[ Debug ] == 2u );
+     BOOST_TEST( stat[ Info ] == 2u );
+
+     /// Следующий шаг восстановления снова ждет restoreDelay
+     BOOST_TEST( !overload.tryRestore( stat ) );
+     BOOST_TEST( overload.shed( Debug ) );
+
+     std::this_thread::sleep_for( std::chrono::milliseconds{ 30 } );
+
+     BOOST_TEST( overload.tryRestore( stat ) );
+     BOOST_TEST( overload.minLevel() == Debug );
+     BOOST_TEST( stat[ Debug ] == 1u );
+     BOOST_TEST( !overload.degraded() );
+}
+BOOST_AUTO_TEST_CASE( TestStuckOutputDoesNotBlockLowLevels )
+{
+     StallingBuf buf;
+     std::ostringstream oss;
+     std::ostream os{ &buf };
+     /// Поток сначала пишет в строку, а затем зависает
+     std::streambuf* const stringBuf = oss.rdbuf();
+     os.rdbuf( stringBuf );
+
+     {
+          alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeOstreamPtr( os ), nullptr };
+          os.rdbuf( &buf );
+
+          /// Запись уровня Warn зависает на выводе, удерживая мьютекс логгера
+          std::thread stuck{ [ &logger ]{ logger.warn() << "stuck"; } };
+          buf.waitStalled();
+
+          const auto start = std::chrono::steady_clock::now();
+          logger.debug() << "dropped";
+          logger.info() << "dropped";
+          logger.info() << "dropped";
+          const auto elapsed = std::chrono::steady_clock::now() - start;
+
+          BOOST_TEST( elapsed < std::chrono::seconds{ 1 } );
+          BOOST_TEST( logger.overload()->minLevel() == Info );
+
+          buf.release();
+          stuck.join();
+
+          /// После зависания в лог выводится сообщение о поднятии уровня,
+          /// а при разрушении логгера - сводка отброшенных записей
+          os.rdbuf( stringBuf );
+          logger.warn() << "resumed";
+     }
+     const auto logged = oss.str();
+     BOOST_TEST( boost::algorithm::contains( logged, "logger output is stalled, records below <info> are dropped" ) );
+     BOOST_TEST( boost::algorithm::contains( logged, "<warn>: resumed" ) );
+     BOOST_TEST( boost::algorithm::contains( logged, "logger dropped records: <debug> 1 <info> 2" ) );
+}
+BOOST_AUTO_TEST_CASE( TestContentionIsNotStall )
+{
+     std::ostringstream oss;
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeOstreamPtr( oss ), nullptr };
+
+     /// Потоки постоянно конкурируют за мьютекс, но записи выводятся без зависаний
+     constexpr auto threads = 8u;
+     constexpr auto iterations = 2'000u;
+     std::vector< std::thread > workers;
+     for( auto i = 0u; i < threads; ++i )
+     {
+          workers.emplace_back(
+               [ &logger ]
+               {
+                    for( auto j = 0u; j < iterations; ++j )
+                    {
+                         logger.debug() << "record " << j;
+                    }
+               });
+     }
+     for( auto&& worker: workers )
+     {
+          worker.join();
+     }
+
+     BOOST_TEST( logger.totalRecords() == threads * iterations );
+     BOOST_TEST( logger.overload()->minLevel() == Debug );
+}
+BOOST_AUTO_TEST_CASE( TestOverloadControlCanBeDisabled )
+{
+     std::ostringstream oss;
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeOstreamPtr( oss ), nullptr, boost::none };
+
+     BOOST_TEST( !logger.overload() );
+     logger.debug() << "record";
+     BOOST_TEST( boost::algorithm::contains( oss.str(), "<debug>: record" ) );
+}
+BOOST_AUTO_TEST_SUITE_END() /// OverloadControllerTest
@@ -0,0 +1,207 @@
+/// @file ring_writer_test.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/directory.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include <logger/ring_writer.h>
+
+
+namespace {
+
+
+using alexen::tiny_logger::ShmRing;
+
+
+/// Уникальное имя сегмента, удаляемого по окончании теста
+struct RingName {
+     explicit RingName( const std::string& suffix = {} )
+          : name{ "/tiny_logger_writer_test." + std::to_string( getpid() ) + suffix }
+     {
+          ShmRing::remove( name );
+     }
+     ~RingName() { ShmRing::remove( name ); }
+     const std::string name;
+};
+
+
+struct LogDir {
+     LogDir()
+          : path{ boost::filesystem::temp_directory_path()
+               / boost::filesystem::unique_path( "tiny_logger_writer_%%%%%%%%" ) }
+     {
+          boost::filesystem::create_directories( path );
+     }
+     ~LogDir() { boost::filesystem::remove_all( path ); }
+     const boost::filesystem::path path;
+};
+
+
+std::string readFile( const boost::filesystem::path& path )
+{
+     boost::filesystem::ifstream ifile{ path };
+     return { std::istreambuf_iterator< char >{ ifile }, {} };
+}
+
+
+std::string readCompressedFile( const boost::filesystem::path& path )
+{
+     boost::filesystem::ifstream ifile{ path, std::ios_base::binary };
+     boost::iostreams::filtering_istream is;
+     is.push( boost::iostreams::gzip_decompressor{} );
+     is.push( ifile );
+     std::ostringstream oss;
+     boost::iostreams::copy( is, oss );
+     return oss.str();
+}
+
+
+} // namespace {unnamed}
+
+
+BOOST_AUTO_TEST_SUITE( RingWriterTest )
+
+using alexen::tiny_logger::RingWriter;
+
+BOOST_AUTO_TEST_CASE( TestRingsAreWrittenToSeparateLogs )
+{
+     const LogDir logDir;
+     /// Имя одного буфера - префикс имени другого
+     const RingName first;
+     const RingName second{ "_second" };
+     const auto firstRing = ShmRing::create( first.name );
+     const auto secondRing = ShmRing::create( second.name );
+
+     const auto maxLogSize = 64u;
+     const auto maxLogFiles = 2u;
+     RingWriter firstWriter{ first.name, logDir.path, maxLogSize, maxLogFiles };
+     RingWriter secondWriter{ second.name, logDir.path, maxLogSize, maxLogFiles };
+
+     const std::string secondRecord = "second\n";
+     BOOST_TEST( secondRing->write( secondRecord.data(), secondRecord.size() ) );
+     BOOST_TEST( secondWriter.drain() );
+
+     /// Постоянная ротация логов первого буфера не затрагивает логи второго
+     const std::string firstRecord = "first record of 32 bytes long..\n";
+     for( auto i = 0; i < 20; ++i )
+     {
+          BOOST_TEST( firstRing->write( firstRecord.data(), firstRecord.size() ) );
+          BOOST_TEST( firstWriter.drain() );
+     }
+     BOOST_TEST( secondRing->write( secondRecord.data(), secondRecord.size() ) );
+     BOOST_TEST( secondWriter.drain() );
+
+     const auto firstApp = first.name.substr( 1u );
+     const auto secondApp = second.name.substr( 1u );
+     auto firstFiles = 0u;
+     auto secondFiles = 0u;
+     for( auto&& entry: boost::filesystem::directory_iterator{ logDir.path } )
+     {
+          const auto filename = entry.path().filename().string();
+          const auto content = readFile( entry.path() );
+          if( boost::algorithm::contains( filename, secondApp ) )
+          {
+               ++secondFiles;
+               BOOST_TEST( content == secondRecord + secondRecord, filename );
+          }
+          else
+          {
+               BOOST_TEST( boost::algorithm::contains( filename, firstApp ), filename );
+               ++firstFiles;
+               BOOST_TEST( !content.empty() );
+               BOOST_TEST( content.find( secondRecord ) == std::string::npos, filename );
+          }
+     }
+     /// Ротация оставляет maxLogFiles логов и текущий
+     BOOST_TEST( firstFiles <= maxLogFiles + 1u );
+     BOOST_TEST( secondFiles == 1u );
+}
+BOOST_AUTO_TEST_CASE( TestFinishedLogsAreCompressed )
+{
+     const LogDir logDir;
+     const RingName name;
+     const auto ring = ShmRing::create( name.name );
+
+     const auto maxLogSize = 64u;
+     const auto maxLogFiles = 3u;
+     RingWriter writer{ name.name, logDir.path, maxLogSize, maxLogFiles, true };
+
+     const auto total = 20u;
+     for( auto i = 0u; i < total; ++i )
+     {
+          const auto record = "record " + std::to_string( i ) + " of 32 bytes long............\n";
+          BOOST_TEST( ring->write( record.data(), record.size() ) );
+          BOOST_TEST( writer.drain() );
+     }
+
+     /// Все логи, кроме текущего, сжаты, а ротация учитывает сжатые логи
+     std::vector< boost::filesystem::path > compressed;
+     std::vector< boost::filesystem::path > plain;
+     for( auto&& entry: boost::filesystem::directory_iterator{ logDir.path } )
+     {
+          ( entry.path().extension() == ".gz" ? compressed : plain ).push_back( entry.path() );
+     }
+     BOOST_TEST_REQUIRE( plain.size() == 1u );
+     BOOST_TEST( compressed.size() == maxLogFiles );
+
+     /// Сжатые логи содержат записи целиком и подряд, а текущий лог их продолжает
+     std::sort( compressed.begin(), compressed.end() );
+     std::string content;
+     for( auto&& each: compressed )
+     {
+          const auto log = readCompressedFile( each );
+          BOOST_TEST( !log.empty() );
+          BOOST_TEST( log.back() == '\n', each );
+          content += log;
+     }
+     content += readFile( plain.front() );
+     BOOST_TEST( boost::algorithm::ends_with( content, "record " + std::to_string( total - 1u ) + " of 32 bytes long............\n" ) );
+     std::istringstream iss{ content };
+     std::string line;
+     std::getline( iss, line );
+     auto expected = boost::lexical_cast< unsigned >( line.substr( 7u, line.find( ' ', 7u ) - 7u ) );
+     do
+     {
+          BOOST_TEST( line == "record " + std::to_string( expected++ ) + " of 32 bytes long............" );
+     }
+     while( std::getline( iss, line ) );
+     BOOST_TEST( expected == total );
+}
+BOOST_AUTO_TEST_CASE( TestMissingRingIsOpenedWhenCreated )
+{
+     const LogDir logDir;
+     const RingName name;
+
+     /// Писатель запущен раньше приложения: буфера еще нет
+     RingWriter writer{ name.name, logDir.path };
+     BOOST_TEST( !writer.attached() );
+     BOOST_TEST( !writer.drain() );
+     BOOST_TEST( boost::filesystem::is_empty( logDir.path ) );
+
+     const auto ring = ShmRing::create( name.name );
+     const std::string record = "record\n";
+     BOOST_TEST( ring->write( record.data(), record.size() ) );
+
+     BOOST_TEST( writer.drain() );
+     BOOST_TEST( writer.attached() );
+     const boost::filesystem::directory_iterator log{ logDir.path };
+     BOOST_TEST_REQUIRE( ( log != boost::filesystem::directory_iterator{} ) );
+     BOOST_TEST( readFile( log->path() ) == record );
+}
+BOOST_AUTO_TEST_SUITE_END() /// RingWriterTest
@@ -5,9 +5,14 @@
 #include <boost/regex.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/directory.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
 #include <set>
+#include <ctime>
+#include <vector>
 
 #include <logger/rotator.h>
 
@@ -40,6 +45,7 @@ BOOST_AUTO_TEST_CASE( TestLogNameRegEx )
           "\nRegex pattern: " << Rotator::logNamePattern <<
           "\nString: " << logName.string()
           );
+     BOOST_TEST( boost::regex_match( logName.filename().string() + Rotator::compressedLogSuffix, regex ) );
 }
 BOOST_AUTO_TEST_CASE( TestGeneratedFileNameUniqueness )
 {
@@ -53,4 +59,71 @@ BOOST_AUTO_TEST_CASE( TestGeneratedFileNameUniqueness )
      }
      BOOST_TEST( names.size() == total );
 }
+BOOST_AUTO_TEST_CASE( TestGeneratedFileNamesAreOrdered )
+{
+     Rotator rotator{ "ApplicationName", "" };
+
+     auto previous = rotator.generateNextLogName();
+     for( auto i = 0; i < 100; ++i )
+     {
+          const auto next = rotator.generateNextLogName();
+          BOOST_TEST( previous.filename() < next.filename() );
+          previous = next;
+     }
+}
+BOOST_AUTO_TEST_CASE( TestRotationKeepsNewestOnSameWriteTime )
+{
+     const auto logDir = boost::filesystem::temp_directory_path()
+          / boost::filesystem::unique_path( "tiny_logger_rotator_%%%%%%%%" );
+     boost::filesystem::create_directories( logDir );
+
+     const auto maxLogFiles = 2u;
+     Rotator rotator{ "ApplicationName", logDir, Rotator::defaultMaxLogSize, maxLogFiles };
+
+     /// При частой ротации время изменения логов совпадает с точностью до секунды
+     const auto writeTime = std::time( nullptr );
+     std::vector< boost::filesystem::path > logs;
+     for( auto i = 0; i < 5; ++i )
+     {
+          logs.push_back( rotator.generateNextLogName() );
+          boost::filesystem::ofstream{ logs.back() } << i;
+          boost::filesystem::last_write_time( logs.back(), writeTime );
+     }
+
+     rotator.rotateLogs();
+
+     std::set< boost::filesystem::path > kept{
+          boost::filesystem::directory_iterator{ logDir }, boost::filesystem::directory_iterator{} };
+     const std::set< boost::filesystem::path > newest{ logs.end() - maxLogFiles, logs.end() };
+     BOOST_TEST( kept == newest, "Rotation must keep the newest logs" );
+
+     boost::filesystem::remove_all( logDir );
+}
+BOOST_AUTO_TEST_CASE( TestRotationIgnoresOtherApps )
+{
+     const auto logDir = boost::filesystem::temp_directory_path()
+          / boost::filesystem::unique_path( "tiny_logger_rotator_%%%%%%%%" );
+     boost::filesystem::create_directories( logDir );
+
+     /// Имя одного приложения - префикс имени другого
+     Rotator app{ "app", logDir, Rotator::defaultMaxLogSize, 1u };
+     Rotator other{ "app_other", logDir, Rotator::defaultMaxLogSize, 1u };
+
+     const auto otherLog = other.generateNextLogName();
+     boost::filesystem::ofstream{ otherLog } << "other";
+
+     /// Лог другого приложения не выбирается текущим
+     const auto appLog = app.getCurrentLogFile();
+     BOOST_TEST( appLog != otherLog );
+     boost::filesystem::ofstream{ appLog } << "app";
+
+     /// и не учитывается (и не удаляется) при ротации
+     app.rotateLogs();
+     other.rotateLogs();
+     BOOST_TEST( boost::filesystem::exists( appLog ) );
+     BOOST_TEST( boost::filesystem::exists( otherLog ) );
+     BOOST_TEST( other.getCurrentLogFile() == otherLog );
+
+     boost::filesystem::remove_all( logDir );
+}
 BOOST_AUTO_TEST_SUITE_END() /// RotatorTest
\ No newline at end of file
@@ -0,0 +1,140 @@
+/// @file shm_ring_test.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include <logger/shm_ring.h>
+
+
+namespace {
+
+
+using alexen::tiny_logger::ShmRing;
+
+
+/// Уникальное имя сегмента, удаляемого по окончании теста
+struct RingName {
+     RingName() : name{ "/tiny_logger_test." + std::to_string( getpid() ) } { ShmRing::remove( name ); }
+     ~RingName() { ShmRing::remove( name ); }
+     const std::string name;
+};
+
+
+std::string readAll( ShmRing& ring )
+{
+     std::string result( ring.capacity(), '\0' );
+     result.resize( ring.read( &result[ 0 ], result.size() ) );
+     return result;
+}
+
+
+} // namespace {unnamed}
+
+
+BOOST_AUTO_TEST_SUITE( ShmRingTest )
+
+BOOST_AUTO_TEST_CASE( TestWriteRead )
+{
+     const RingName shm;
+     const auto writer = ShmRing::create( shm.name, 1000u );
+     const auto reader = ShmRing::open( shm.name );
+
+     BOOST_TEST( writer->capacity() == 1024u );
+     BOOST_TEST( reader->capacity() == 1024u );
+
+     BOOST_TEST( writer->write( "first\n", 6u ) );
+     BOOST_TEST( writer->write( "second\n", 7u ) );
+     BOOST_TEST( readAll( *reader ) == "first\nsecond\n" );
+     BOOST_TEST( readAll( *reader ).empty() );
+}
+BOOST_AUTO_TEST_CASE( TestWrapAround )
+{
+     const RingName shm;
+     const auto ring = ShmRing::create( shm.name, 16u );
+     char buffer[ 16 ];
+
+     BOOST_TEST( ring->write( "0123456789", 10u ) );
+     BOOST_TEST( ring->read( buffer, 10u ) == 10u );
+
+     /// Запись переходит через конец буфера
+     BOOST_TEST( ring->write( "abcdefghij", 10u ) );
+     BOOST_TEST( readAll( *ring ) == "abcdefghij" );
+}
+BOOST_AUTO_TEST_CASE( TestOverflowDropsWholeChunk )
+{
+     const RingName shm;
+     const auto ring = ShmRing::create( shm.name, 16u );
+
+     BOOST_TEST( ring->write( "0123456789", 10u ) );
+     BOOST_TEST( !ring->write( "abcdefghij", 10u ) );
+     BOOST_TEST( ring->dropped() == 10u );
+     BOOST_TEST( readAll( *ring ) == "0123456789" );
+}
+BOOST_AUTO_TEST_CASE( TestDataSurvivesWriter )
+{
+     const RingName shm;
+     {
+          const auto writer = ShmRing::create( shm.name );
+          BOOST_TEST( writer->write( "before crash\n", 13u ) );
+     }
+     /// Повторное создание не затирает непрочитанные данные
+     const auto writer = ShmRing::create( shm.name );
+     BOOST_TEST( writer->write( "after restart\n", 14u ) );
+     BOOST_TEST( readAll( *ShmRing::open( shm.name ) ) == "before crash\nafter restart\n" );
+}
+BOOST_AUTO_TEST_CASE( TestLoggerSink )
+{
+     const RingName shm;
+     const auto ring = ShmRing::create( shm.name );
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeShmRingOstream( ring ) };
+
+     /// Каждая запись попадает в буфер сразу, а не при разрушении логгера
+     logger.info() << "record " << 1;
+     BOOST_TEST( boost::algorithm::ends_with( readAll( *ring ), "<info>: record 1\n" ) );
+
+     logger.warn() << "record " << 2;
+     BOOST_TEST( boost::algorithm::ends_with( readAll( *ring ), "<warn>: record 2\n" ) );
+}
+BOOST_AUTO_TEST_CASE( TestLoggerSinkIsNotDuplicatedToConsole )
+{
+     const RingName shm;
+     const auto ring = ShmRing::create( shm.name );
+     std::ostringstream console;
+     const auto cerrBuf = std::cerr.rdbuf( console.rdbuf() );
+     {
+          alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeShmRingOstream( ring ) };
+          logger.info() << "record";
+     }
+     std::cerr.rdbuf( cerrBuf );
+
+     BOOST_TEST( console.str().empty() );
+     BOOST_TEST( boost::algorithm::ends_with( readAll( *ring ), "<info>: record\n" ) );
+}
+BOOST_AUTO_TEST_CASE( TestLongRecordsAreWrittenWhole )
+{
+     const RingName shm;
+     const auto ring = ShmRing::create( shm.name, 8192u );
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeShmRingOstream( ring ) };
+
+     /// Запись длиннее буфера потока попадает в кольцевой буфер целиком
+     const std::string payload( 5000u, 'x' );
+     logger.info() << payload;
+     BOOST_TEST( ring->dropped() == 0u );
+
+     /// Вторая такая же запись не помещается и отбрасывается целиком
+     logger.info() << payload;
+     const auto logged = readAll( *ring );
+     BOOST_TEST( boost::algorithm::ends_with( logged, payload + '\n' ) );
+     BOOST_TEST( std::count( logged.begin(), logged.end(), '\n' ) == 1 );
+     BOOST_TEST( ring->dropped() == logged.size() );
+}
+BOOST_AUTO_TEST_SUITE_END() /// ShmRingTest
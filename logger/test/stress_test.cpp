@@ -0,0 +1,496 @@
+/// @file stress_test.cpp
+/// @brief Нагрузочная проверка целостности записей при постоянной ротации.
+///
+/// Каждый поток пишет записи с собственным порядковым номером и содержимым,
+/// вычисляемым по номеру потока и записи. Маленькие @a maxLogSize и @a maxLogFiles
+/// заставляют логгер ротировать логи постоянно. После записи все оставшиеся файлы
+/// перечитываются и проверяется, что:
+/// - каждая строка - это целая запись (нет перемешанных и оборванных строк);
+/// - записи каждого потока идут подряд без пропусков и перестановок как внутри файла,
+///   так и при переходе от файла к файлу (файлы перебираются в порядке создания),
+///   пропущены могут быть только записи, отброшенные контроллером перегрузки;
+/// - сквозной порядковый номер записи, назначаемый под мьютексом логгера, идет подряд
+///   по всем файлам, т.е. пропуск допустим только перед первым сохранившимся файлом:
+///   пропадают только самые старые записи вместе с целыми файлами, удаленными ротацией;
+/// - записи каждого потока заканчиваются последней записью уровня Warn;
+/// - ротация оставляет не больше @a maxLogFiles логов (не считая текущего);
+/// - по пути в файлы ничего не отброшено (переполнение буфера или очереди приемника).
+///
+/// Режимы (первый параметр):
+/// - file - логгер сам пишет в файлы с ротацией;
+/// - shm  - логгер пишет в кольцевой буфер в разделяемой памяти, а отдельный поток
+///   вычитывает его и пишет в файлы с ротацией так же, как утилита tiny_logger_writer;
+/// - asio - логгер пишет в асинхронный приемник, выводящий в один файл на пуле потоков;
+/// - mixed - как file, но записи Debug и Info перемежаются с Warn, а часть записей Warn
+///   удерживает мьютекс логгера дольше допустимого ожидания, поэтому контроллер перегрузки
+///   отбрасывает записи и меняет уровни. Дополнительно проверяется, что каждая запись
+///   либо записана, либо учтена как отброшенная.
+///
+/// Запускается через CTest в каждом режиме, с опцией TINY_LOGGER_STRESS_TSAN - под ThreadSanitizer.
+///
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <map>
+#include <set>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/regex.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/optional.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/directory.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <logger/logger.h>
+#include <logger/shm_ring.h>
+#include <logger/asio_sink.h>
+#include <logger/ring_writer.h>
+
+
+namespace {
+
+
+using Seq = std::size_t;
+
+
+/// Содержимое записи однозначно определяется номером потока и записи,
+/// а длина меняется, чтобы границы записей не совпадали с границами буферов
+std::string makePayload( const unsigned thread, const Seq seq )
+{
+     std::string payload( 10u + ( thread * 7u + seq ) % 90u, '\0' );
+     for( auto i = 0u; i < payload.size(); ++i )
+     {
+          payload[ i ] = static_cast< char >( 'a' + ( thread + seq + i ) % 26u );
+     }
+     return payload;
+}
+
+
+/// Сквозной номер записи в порядке вывода. Выводится в запись, пока она удерживает
+/// мьютекс логгера, поэтому защищен им же (что заодно проверяет ThreadSanitizer)
+struct WriteOrder {
+     mutable Seq next = 0u;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const WriteOrder& order )
+{
+     return os << order.next++;
+}
+
+
+/// Задержка вывода записи: запись, выводящая ее, удерживает мьютекс логгера,
+/// как при зависании выходного потока
+struct Hold {
+     bool hold;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const Hold& hold )
+{
+     if( hold.hold )
+     {
+          boost::this_thread::sleep_for( boost::chrono::milliseconds{ 2 } );
+     }
+     return os;
+}
+
+
+/// Уровень записи определяется ее номером. Уровень Warn контроллер перегрузки
+/// никогда не отбрасывает, поэтому без перемешивания уровней (@a mixed) записи
+/// пишутся только с ним, и любой пропуск - это потеря
+alexen::tiny_logger::Level levelOf( const Seq seq, const bool mixed )
+{
+     using namespace alexen::tiny_logger;
+     static const Level levels[] = { Debug, Info, Warn };
+     return mixed ? levels[ seq % 3u ] : Warn;
+}
+
+
+void worker( alexen::tiny_logger::Logger& logger, WriteOrder& order, const unsigned thread, const Seq iterations, const bool mixed )
+{
+     for( Seq seq = 0u; seq < iterations; ++seq )
+     {
+          const Hold hold{ mixed && seq % 60u == 2u };
+          logger( levelOf( seq, mixed ) )
+               << "stress " << thread << ' ' << seq << ' ' << order << ' ' << makePayload( thread, seq ) << hold;
+     }
+}
+
+
+class Verifier {
+public:
+     Verifier( const unsigned threads, const Seq iterations, const bool mixed )
+          : threads_{ threads }, iterations_{ iterations }, mixed_{ mixed } {}
+
+     /// Файлы должны проверяться в порядке создания
+     void verifyFile( const boost::filesystem::path& path )
+     {
+          static const boost::regex record{
+               R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2} \{[0-9a-f]+\} <(debug|info|warn|error)>: (.*))" };
+          static const char* const levelNames[] = { "debug", "info", "warn", "error" };
+          static const boost::regex stress{ R"(stress (\d+) (\d+) (\d+) ([a-z]+))" };
+
+          boost::filesystem::ifstream ifile{ path };
+          std::string line;
+          boost::smatch match;
+          for( auto lineNo = 1u; std::getline( ifile, line ); ++lineNo )
+          {
+               const auto where = path.filename().string() + ':' + std::to_string( lineNo ) + ": ";
+               if( !boost::regex_match( line, match, record ) )
+               {
+                    fail( where + "malformed record: " + line );
+                    continue;
+               }
+               const std::string level = match[ 1 ];
+               const std::string text = match[ 2 ];
+               if( !boost::regex_match( text, match, stress ) )
+               {
+                    /// Служебные записи логгера (например, о перегрузке)
+                    continue;
+               }
+               const auto thread = boost::lexical_cast< unsigned >( match[ 1 ] );
+               const auto seq = boost::lexical_cast< Seq >( match[ 2 ] );
+               const auto order = boost::lexical_cast< Seq >( match[ 3 ] );
+               if( thread >= threads_ || seq >= iterations_ || match[ 4 ] != makePayload( thread, seq ) )
+               {
+                    fail( where + "corrupted record: " + line );
+                    continue;
+               }
+               if( level != levelNames[ levelOf( seq, mixed_ ) ] )
+               {
+                    fail( where + "wrong level: " + line );
+               }
+               /// Более ранние записи (в т.ч. записи потока, впервые встреченного в этом файле)
+               /// могут пропасть только вместе с файлами, удаленными ротацией
+               if( nextOrder_ && order != *nextOrder_ )
+               {
+                    fail( where + "expected record #" + std::to_string( *nextOrder_ ) + ", got #" + std::to_string( order ) );
+               }
+               nextOrder_ = order + 1u;
+               const auto expected = next_.find( thread );
+               if( expected != next_.end() && !skippable( expected->second, seq ) )
+               {
+                    fail( where + "thread " + std::to_string( thread ) + " expected record "
+                         + std::to_string( expected->second ) + ", got " + std::to_string( seq ) );
+               }
+               next_[ thread ] = seq + 1u;
+               if( !seen_[ thread ].insert( seq ).second )
+               {
+                    fail( where + "duplicate record: " + line );
+               }
+          }
+     }
+
+     /// Поток, закончивший писать раньше других, мог целиком остаться в удаленных файлах,
+     /// но если записи потока сохранились, то это непрерывный диапазон до последней записи:
+     /// ротация удаляет только самые старые файлы. Пропуски записей Debug и Info проверены
+     /// по ходу чтения файлов.
+     void verifyRanges()
+     {
+          auto last = iterations_ - 1u;
+          while( levelOf( last, mixed_ ) != alexen::tiny_logger::Warn )
+          {
+               --last;
+          }
+          bool anySurvived = false;
+          for( auto&& each: seen_ )
+          {
+               const auto& seqs = each.second;
+               const auto name = "thread " + std::to_string( each.first );
+               if( *seqs.rbegin() < last )
+               {
+                    fail( name + ": last record " + std::to_string( *seqs.rbegin() ) + " is lost" );
+               }
+               if( !mixed_ && *seqs.rbegin() - *seqs.begin() + 1u != seqs.size() )
+               {
+                    fail( name + ": records " + std::to_string( *seqs.begin() ) + ".." + std::to_string( *seqs.rbegin() )
+                         + " have gaps (" + std::to_string( seqs.size() ) + " survived)" );
+               }
+               anySurvived = true;
+          }
+          /// Текущий файл ротация не удаляет, поэтому что-то сохраниться должно всегда
+          if( !anySurvived )
+          {
+               fail( "no records survived" );
+          }
+     }
+
+     std::size_t survived() const
+     {
+          std::size_t total = 0u;
+          for( auto&& each: seen_ )
+          {
+               total += each.second.size();
+          }
+          return total;
+     }
+
+     std::size_t errors() const noexcept { return errors_; }
+
+private:
+     /// Между ожидаемой записью @a expected и прочитанной @a seq могут быть пропущены
+     /// только записи, которые контроллер перегрузки мог отбросить
+     bool skippable( Seq expected, const Seq seq ) const
+     {
+          if( seq < expected )
+          {
+               return false;
+          }
+          for( ; expected < seq; ++expected )
+          {
+               if( levelOf( expected, mixed_ ) >= alexen::tiny_logger::Warn )
+               {
+                    return false;
+               }
+          }
+          return true;
+     }
+
+     void fail( const std::string& message )
+     {
+          /// Выводим только первые ошибки, остальные лишь считаем
+          if( errors_++ < 20u )
+          {
+               std::cerr << "error: " << message << '\n';
+          }
+     }
+
+     const unsigned threads_;
+     const Seq iterations_;
+     const bool mixed_;
+     /// Следующий ожидаемый сквозной номер записи
+     boost::optional< Seq > nextOrder_;
+     /// Следующая ожидаемая запись каждого потока
+     std::map< unsigned, Seq > next_;
+     std::map< unsigned, std::set< Seq > > seen_;
+     std::size_t errors_ = 0u;
+};
+
+
+struct Options {
+     std::string mode;
+     unsigned threads;
+     Seq iterations;
+     std::size_t maxLogSize;
+     unsigned maxLogFiles;
+     boost::filesystem::path logDir;
+     bool mixed;
+};
+
+
+void runWorkers( alexen::tiny_logger::Logger& logger, const Options& opts )
+{
+     WriteOrder order;
+     boost::thread_group tg;
+     for( auto i = 0u; i < opts.threads; ++i )
+     {
+          tg.create_thread( boost::bind( worker, boost::ref( logger ), boost::ref( order ), i, opts.iterations, opts.mixed ) );
+     }
+     tg.join_all();
+}
+
+
+/// Возвращает кол-во байт, потерянных по пути в файлы
+std::size_t runFile( const Options& opts )
+{
+     alexen::tiny_logger::Logger logger{ "stress", opts.logDir, nullptr, opts.maxLogSize, opts.maxLogFiles };
+     runWorkers( logger, opts );
+     return 0u;
+}
+
+
+/// Буфер вычитывается параллельно с записью, поэтому он меньше общего объема записей
+/// и запись идет с переходом через конец буфера
+std::size_t runShm( const Options& opts )
+{
+     namespace tl = alexen::tiny_logger;
+
+     const auto ringName = "/tiny_logger_stress." + std::to_string( getpid() );
+     tl::ShmRing::remove( ringName );
+     const auto ring = tl::ShmRing::create( ringName, 1024u * 1024u );
+     {
+          tl::Logger logger{ tl::makeShmRingOstream( ring ) };
+
+          boost::atomic< bool > stopped = { false };
+          boost::thread drainer{
+               [ & ]
+               {
+                    tl::RingWriter writer{ ringName, opts.logDir, opts.maxLogSize, opts.maxLogFiles };
+                    while( !stopped.load() )
+                    {
+                         if( !writer.drain() )
+                         {
+                              boost::this_thread::sleep_for( boost::chrono::microseconds{ 100 } );
+                         }
+                    }
+                    writer.drain();
+               } };
+
+          runWorkers( logger, opts );
+          stopped = true;
+          drainer.join();
+     }
+     tl::ShmRing::remove( ringName );
+     return ring->dropped();
+}
+
+
+/// Возвращает кол-во записей, которые не записаны и не учтены как отброшенные.
+/// Ожидание мьютекса логгера намного короче задержки вывода записей (@a Hold),
+/// поэтому при конкуренции за него записи Debug и Info отбрасываются.
+std::size_t runMixed( const Options& opts, std::size_t& shed )
+{
+     namespace tl = alexen::tiny_logger;
+
+     tl::OverloadSettings settings;
+     settings.maxLockWait = std::chrono::microseconds{ 200 };
+     settings.restoreDelay = std::chrono::milliseconds{ 5 };
+     settings.raiseDelay = std::chrono::milliseconds{ 1 };
+
+     tl::Logger logger{ "stress", opts.logDir, nullptr, opts.maxLogSize, opts.maxLogFiles, settings };
+     runWorkers( logger, opts );
+     shed = logger.overload()->totalShed();
+     return opts.threads * opts.iterations - logger.totalRecords() - shed;
+}
+
+
+std::size_t runAsio( const Options& opts )
+{
+     namespace tl = alexen::tiny_logger;
+
+     const auto fd = ::open( ( opts.logDir / "stress.log" ).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+     if( fd < 0 )
+     {
+          throw std::runtime_error{ "cannot open log file" };
+     }
+     boost::asio::thread_pool pool{ 1u };
+     const auto sink = tl::AsioSink::create( pool.get_executor(), fd );
+     {
+          tl::Logger logger{ tl::makeAsioOstream( sink ) };
+          runWorkers( logger, opts );
+     }
+     sink->asyncFlush( boost::asio::use_future ).get();
+     pool.join();
+     return sink->dropped();
+}
+
+
+} // namespace {unnamed}
+
+
+/// Параметры (все, кроме режима, необязательные): режим (file, shm, asio или mixed), кол-во потоков,
+/// кол-во записей на поток, максимальный размер лога и максимальное кол-во логов
+int main( const int argc, char** argv )
+{
+     try
+     {
+          Options opts;
+          opts.mode = argc > 1 ? argv[ 1 ] : "file";
+          opts.threads = argc > 2 ? std::stoul( argv[ 2 ] ) : 8u;
+          opts.iterations = argc > 3 ? std::stoull( argv[ 3 ] ) : 2'000u;
+          opts.maxLogSize = argc > 4 ? std::stoull( argv[ 4 ] ) : 8u * 1024u;
+          opts.maxLogFiles = argc > 5 ? std::stoul( argv[ 5 ] ) : 20u;
+          opts.logDir = boost::filesystem::temp_directory_path()
+               / boost::filesystem::unique_path( "tiny_logger_stress_%%%%%%%%" );
+          boost::filesystem::create_directories( opts.logDir );
+
+          opts.mixed = opts.mode == "mixed";
+
+          std::size_t lost = 0u;
+          std::size_t shed = 0u;
+          if( opts.mode == "file" )
+          {
+               lost = runFile( opts );
+          }
+          else if( opts.mode == "shm" )
+          {
+               lost = runShm( opts );
+          }
+          else if( opts.mode == "asio" )
+          {
+               lost = runAsio( opts );
+          }
+          else if( opts.mixed )
+          {
+               lost = runMixed( opts, shed );
+          }
+          else
+          {
+               std::cerr << "usage: " << argv[ 0 ] << " file|shm|asio|mixed [threads [iterations [max-log-size [max-log-files]]]]\n";
+               return 2;
+          }
+
+          Verifier verifier{ opts.threads, opts.iterations, opts.mixed };
+          /// Имена логов упорядочены по времени создания
+          const std::set< boost::filesystem::path > logs{
+               boost::filesystem::directory_iterator{ opts.logDir }, boost::filesystem::directory_iterator{} };
+          const auto files = logs.size();
+          for( auto&& log: logs )
+          {
+               verifier.verifyFile( log );
+          }
+          verifier.verifyRanges();
+
+          /// Ротация выполняется перед созданием нового лога,
+          /// поэтому кроме maxLogFiles логов может остаться еще текущий
+          const auto maxFiles = opts.mode == "asio" ? 1u : opts.maxLogFiles + 1u;
+          const auto total = opts.threads * opts.iterations;
+
+          std::cout
+               << "Stress stat (" << opts.mode << ")\n"
+               << " - threads   : " << opts.threads << '\n'
+               << " - records   : " << total << " (" << verifier.survived() << " survived)\n"
+               << " - files     : " << files << " (max " << maxFiles << ")\n"
+               << " - shed      : " << shed << '\n'
+               << " - lost      : " << lost << ( opts.mixed ? " records" : " bytes" ) << '\n'
+               << " - errors    : " << verifier.errors() << '\n';
+
+          auto failed = verifier.errors() != 0u;
+          if( files > maxFiles )
+          {
+               std::cerr << "error: " << files << " logs kept, rotation allows " << maxFiles << '\n';
+               failed = true;
+          }
+          if( lost )
+          {
+               std::cerr << "error: " << lost << ( opts.mixed ? " records neither written nor shed\n"
+                                                               : " bytes lost on the way to the logs\n" );
+               failed = true;
+          }
+          /// Иначе режим mixed не проверил бы отбрасывание записей
+          if( opts.mixed && !shed )
+          {
+               std::cerr << "error: no records were shed\n";
+               failed = true;
+          }
+          /// Без ротации должны сохраниться все записи
+          if( opts.mode == "asio" && verifier.survived() != total )
+          {
+               std::cerr << "error: " << total - verifier.survived() << " records lost\n";
+               failed = true;
+          }
+          if( failed )
+          {
+               std::cerr << "logs kept in " << opts.logDir << '\n';
+               return 1;
+          }
+          boost::filesystem::remove_all( opts.logDir );
+     }
+     catch( const std::exception& e )
+     {
+          std::cerr << "exception: " << boost::diagnostic_information( e ) << '\n';
+          return 1;
+     }
+     return 0;
+}
@@ -0,0 +1,90 @@
+/// @file timing_test.cpp
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <string>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+
+#include <logger/macro.h>
+
+
+namespace {
+
+
+/// Логгер, пишущий в строку
+struct StringLogger {
+     std::ostringstream oss;
+     alexen::tiny_logger::Logger logger{ alexen::tiny_logger::makeOstreamPtr( oss ), nullptr };
+};
+
+
+} // namespace {unnamed}
+
+
+BOOST_AUTO_TEST_SUITE( TimingTest )
+
+using alexen::tiny_logger::TscClock;
+
+BOOST_AUTO_TEST_CASE( TestTscClockCalibration )
+{
+     const auto start = TscClock::now();
+     std::this_thread::sleep_for( std::chrono::milliseconds{ 20 } );
+     const auto elapsed = TscClock::toDuration( TscClock::now() - start );
+
+     BOOST_TEST( elapsed >= std::chrono::milliseconds{ 19 } );
+     BOOST_TEST( elapsed < std::chrono::milliseconds{ 200 } );
+}
+BOOST_AUTO_TEST_CASE( TestTscClockIsCalibratedOnce )
+{
+     TscClock::calibrate();
+
+     /// Калибровка (~10 мс) уже выполнена и не повторяется
+     const auto start = std::chrono::steady_clock::now();
+     TscClock::calibrate();
+     BOOST_TEST( TscClock::toDuration( TscClock::fromDuration( std::chrono::milliseconds{ 1 } ) ).count() > 0 );
+     const auto elapsed = std::chrono::steady_clock::now() - start;
+     BOOST_TEST( elapsed < std::chrono::milliseconds{ 5 } );
+
+     /// Без инвариантного TSC такт равен наносекунде steady_clock
+     if( !TscClock::usesTsc() )
+     {
+          BOOST_TEST( TscClock::fromDuration( std::chrono::milliseconds{ 1 } ) == 1'000'000u );
+     }
+}
+BOOST_AUTO_TEST_CASE( TestScopeTimeThreshold )
+{
+     StringLogger log;
+     {
+          LOG_SCOPE_TIME_OVER( log.logger, "fast", std::chrono::seconds{ 10 } );
+     }
+     BOOST_TEST( log.oss.str().empty() );
+     {
+          LOG_SCOPE_TIME_OVER( log.logger, "slow", std::chrono::milliseconds{ 1 } );
+          std::this_thread::sleep_for( std::chrono::milliseconds{ 2 } );
+     }
+     BOOST_TEST( boost::algorithm::contains( log.oss.str(), "(timing_test.cpp:" ) );
+     BOOST_TEST( boost::algorithm::contains( log.oss.str(), ") slow took " ) );
+}
+BOOST_AUTO_TEST_CASE( TestScopeStatReport )
+{
+     StringLogger log;
+     auto iterations = 0;
+     while( log.oss.str().empty() && iterations < 1000 )
+     {
+          ++iterations;
+          LOG_SCOPE_STAT_PERIOD( log.logger, "loop", std::chrono::milliseconds{ 20 } );
+          std::this_thread::sleep_for( std::chrono::milliseconds{ 1 } );
+     }
+     /// Замеры не выводятся по одному: одна сводка на все замеры периода
+     const auto logged = log.oss.str();
+     BOOST_TEST( iterations > 1 );
+     BOOST_TEST( std::count( logged.begin(), logged.end(), '\n' ) == 1 );
+     BOOST_TEST( boost::algorithm::contains( logged, ") loop: count " + std::to_string( iterations ) + ", min " ) );
+     BOOST_TEST( boost::algorithm::contains( logged, ", p99 " ) );
+}
+BOOST_AUTO_TEST_SUITE_END() /// TimingTest
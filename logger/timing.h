@@ -0,0 +1,183 @@
+/// @file timing.h
+/// @brief
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#    include <x86intrin.h>
+#endif
+
+#include <boost/atomic.hpp>
+
+#include <logger/logger.h>
+
+
+namespace alexen {
+namespace tiny_logger {
+
+
+/// Часы на основе счетчика тактов процессора (TSC).
+///
+/// Чтение счетчика намного дешевле вызова steady_clock::now(), а перевод тактов
+/// в наносекунды выполняется только при выводе результата. Калибровка по steady_clock
+/// (~10 мс) выполняется при первом обращении к часам, т.е. только в процессах, которые
+/// ими пользуются. Чтобы ее не ждал первый замер, приложение может вызвать @a calibrate()
+/// при старте.
+///
+/// @note TSC используется, только если он инвариантный (CPUID 0x80000007, EDX бит 8), т.е. идет
+/// с постоянной частотой независимо от частоты и сна ядер. Иначе, как и на платформах без TSC,
+/// используется steady_clock, а такт равен наносекунде.
+///
+class TscClock {
+public:
+     using rep = std::uint64_t;
+
+     static rep now() noexcept
+     {
+#if defined( __x86_64__ ) || defined( __i386__ )
+          if( calibration().invariantTsc )
+          {
+               return __rdtsc();
+          }
+#endif
+          return std::chrono::duration_cast< std::chrono::nanoseconds >(
+               std::chrono::steady_clock::now().time_since_epoch() ).count();
+     }
+
+     /// Выполняет калибровку, если она еще не выполнена
+     static void calibrate() noexcept { calibration(); }
+
+     /// Признак того, что часы используют TSC, а не steady_clock
+     static bool usesTsc() noexcept { return calibration().invariantTsc; }
+
+     static std::chrono::nanoseconds toDuration( rep ticks ) noexcept;
+     static rep fromDuration( std::chrono::nanoseconds duration ) noexcept;
+
+private:
+     struct Calibration {
+          Calibration() noexcept;
+
+          bool invariantTsc = false;
+          double ticksPerNanosecond = 1.;
+     };
+
+     static const Calibration& calibration() noexcept
+     {
+          static const Calibration instance;
+          return instance;
+     }
+};
+
+
+/// Замер времени выполнения блока кода: по выходу из блока выводит в лог
+/// затраченное время, если оно не меньше порога @a threshold.
+///
+/// @note Используйте через макросы @a LOG_SCOPE_TIME и @a LOG_SCOPE_TIME_OVER.
+///
+class ScopeTimer {
+public:
+     static constexpr auto defaultThreshold = std::chrono::milliseconds{ 1 };
+
+     ScopeTimer(
+          Logger& logger
+          , std::string_view file
+          , unsigned line
+          , const char* name
+          , std::chrono::nanoseconds threshold = ScopeTimer::defaultThreshold
+          ) noexcept;
+     ~ScopeTimer();
+
+     ScopeTimer( const ScopeTimer& ) = delete;
+     ScopeTimer& operator=( const ScopeTimer& ) = delete;
+
+private:
+     Logger& logger_;
+     const std::string_view file_;
+     const unsigned line_;
+     const char* const name_;
+     const TscClock::rep threshold_;
+     const TscClock::rep start_;
+};
+
+
+/// Статистика времени выполнения блока кода в одной точке вызова.
+///
+/// Вместо вывода каждого замера накапливает кол-во, минимум, среднее, максимум
+/// и гистограмму замеров и раз в период @a period выводит сводку в лог.
+/// Накопление выполняется без блокировок, поэтому одну статистику можно
+/// пополнять из нескольких потоков.
+///
+/// @note Перцентили приблизительные: гистограмма хранит замеры с точностью
+/// до степени двойки, и в сводку выводится верхняя граница соответствующего интервала.
+///
+/// @note Используйте через макросы @a LOG_SCOPE_STAT и @a LOG_SCOPE_STAT_PERIOD.
+///
+class TimingStat {
+public:
+     static constexpr auto defaultReportPeriod = std::chrono::seconds{ 60 };
+
+     TimingStat(
+          std::string_view file
+          , unsigned line
+          , const char* name
+          , std::chrono::nanoseconds period = TimingStat::defaultReportPeriod
+          ) noexcept;
+
+     TimingStat( const TimingStat& ) = delete;
+     TimingStat& operator=( const TimingStat& ) = delete;
+
+     /// Учитывает замер @a ticks и, если период истек, выводит сводку в @a logger
+     void add( TscClock::rep ticks, Logger& logger );
+
+private:
+     /// Интервалы гистограммы: i-й интервал содержит замеры из [2^(i-1), 2^i) тактов
+     static constexpr auto histogramSize = 65u;
+
+     void report( Logger& logger );
+
+     const std::string_view file_;
+     const unsigned line_;
+     const char* const name_;
+     const TscClock::rep period_;
+
+     boost::atomic< TscClock::rep > lastReport_;
+     boost::atomic< std::uint64_t > count_ = { 0u };
+     boost::atomic< TscClock::rep > sum_ = { 0u };
+     boost::atomic< TscClock::rep > min_;
+     boost::atomic< TscClock::rep > max_ = { 0u };
+     std::array< boost::atomic< std::uint64_t >, histogramSize > histogram_ = {};
+};
+
+
+/// Замер времени выполнения блока кода с учетом в @a TimingStat
+class ScopeStatTimer {
+public:
+     ScopeStatTimer( TimingStat& stat, Logger& logger ) noexcept
+          : stat_{ stat }
+          , logger_{ logger }
+          , start_{ TscClock::now() }
+     {}
+
+     ~ScopeStatTimer()
+     {
+          stat_.add( TscClock::now() - start_, logger_ );
+     }
+
+     ScopeStatTimer( const ScopeStatTimer& ) = delete;
+     ScopeStatTimer& operator=( const ScopeStatTimer& ) = delete;
+
+private:
+     TimingStat& stat_;
+     Logger& logger_;
+     const TscClock::rep start_;
+};
+
+
+} // namespace tiny_logger
+} // namespace alexen
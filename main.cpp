@@ -64,7 +64,16 @@ int main( const int argc, char** argv )
      boost::ignore_unused( argc, argv );
      try
      {
-          alexen::tiny_logger::Logger logger{ "appname", "./logs", nullptr };
+          /// Проверка кол-ва байт ниже рассчитана на то, что ни одна запись не отброшена,
+          /// поэтому отбрасывание записей при перегрузке отключено
+          alexen::tiny_logger::Logger logger{
+               "appname"
+               , "./logs"
+               , nullptr
+               , alexen::tiny_logger::Rotator::defaultMaxLogSize
+               , alexen::tiny_logger::Rotator::defaultMaxLogFiles
+               , boost::none
+               };
 
           std::size_t iterations = 1'000u;
           std::size_t threads = boost::thread::hardware_concurrency();
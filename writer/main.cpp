@@ -0,0 +1,92 @@
+/// @file main.cpp
+/// @brief Внепроцессный писатель логов: вычитывает записи из кольцевых буферов
+/// в разделяемой памяти (@a ShmRing) и пишет их в файлы с ротацией (@a Rotator).
+/// Завершенные логи сжимаются gzip.
+/// @copyright Copyright 2023 InfoTeCS Internet Trust
+
+#include <signal.h>
+
+#include <list>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+#include <boost/atomic.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <logger/ring_writer.h>
+
+
+namespace {
+
+
+boost::atomic< bool > stopped = { false };
+
+void onSignal( int )
+{
+     stopped = true;
+}
+
+
+} // namespace {unnamed}
+
+
+int main( const int argc, char** argv )
+{
+     if( argc < 3 )
+     {
+          std::cerr << "usage: " << argv[ 0 ] << " <log-dir> <ring-name>...\n";
+          return 2;
+     }
+     try
+     {
+          const boost::filesystem::path logDir{ argv[ 1 ] };
+          boost::filesystem::create_directories( logDir );
+
+          std::list< alexen::tiny_logger::RingWriter > writers;
+          for( auto i = 2; i < argc; ++i )
+          {
+               writers.emplace_back(
+                    argv[ i ]
+                    , logDir
+                    , alexen::tiny_logger::Rotator::defaultMaxLogSize
+                    , alexen::tiny_logger::Rotator::defaultMaxLogFiles
+                    , true
+                    );
+               if( !writers.back().attached() )
+               {
+                    std::cerr << "waiting for ring " << writers.back().ringName() << '\n';
+               }
+          }
+
+          signal( SIGINT, onSignal );
+          signal( SIGTERM, onSignal );
+
+          while( !stopped )
+          {
+               bool any = false;
+               for( auto&& writer: writers )
+               {
+                    any = writer.drain() || any;
+               }
+               if( !any )
+               {
+                    std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } );
+               }
+          }
+
+          /// Дописываем все, что осталось в буферах к моменту остановки
+          for( auto&& writer: writers )
+          {
+               writer.drain();
+          }
+     }
+     catch( const std::exception& e )
+     {
+          std::cerr << "exception: " << boost::diagnostic_information( e ) << '\n';
+          return 1;
+     }
+     return 0;
+}